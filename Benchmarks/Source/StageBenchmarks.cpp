@@ -0,0 +1,352 @@
+/*
+  ==============================================================================
+
+    StageBenchmarks.cpp
+    Created: 17 Oct 2026 7:12:40pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <benchmark/benchmark.h>
+#include "../../Source/TapeSim.h"
+#include "../../Source/ModDelay.h"
+
+/*  Every benchmark runs one stage on blocks of noise and reports ns/sample, counted
+    at the host rate and per channel, so stages that run oversampled or on several
+    channels compare directly with the full machine.
+
+    Arguments are sample rate, block size and number of channels. Stages that don't
+    depend on the channel count only run with one channel. The hysteresis and the whole
+    machine also run in double, as the ...Double benchmarks. TapeMachineSubBlock takes
+    the machine's sub-block size in place of the channel count and runs stereo.
+    TapeMachineSilence times the machine once silent input has let it go idle.
+*/
+
+namespace
+{
+    // The plugin's default of 16x
+    constexpr int oversamplingOrder = 4;
+    constexpr int oversamplingFactor = 1 << oversamplingOrder;
+
+    double getSampleRate(const benchmark::State& state) { return (double) state.range(0); }
+    int getBlockSize(const benchmark::State& state) { return (int) state.range(1); }
+    int getNumChannels(const benchmark::State& state) { return (int) state.range(2); }
+
+    template <typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer, float level = 0.5f)
+    {
+        juce::Random random(1234);
+        for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+        {
+            auto* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); i++)
+                data[i] = (SampleType) ((random.nextFloat() * 2.f - 1.f) * level);
+        }
+    }
+
+    void setNsPerSample(benchmark::State& state, int samplesPerIteration)
+    {
+        const auto samples = (int64_t) state.iterations() * samplesPerIteration;
+        state.SetItemsProcessed(samples);
+        state.counters["ns_per_sample"] = benchmark::Counter((double) samples * 1e-9, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+
+    void stageArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "rate", "block", "channels" });
+        b->ArgsProduct({ { 44100, 48000, 96000, 192000 }, { 16, 64, 256, 1024, 2048 }, { 1 } });
+    }
+
+    void channelArguments(benchmark::internal::Benchmark* b)
+    {
+        b->ArgNames({ "rate", "block", "channels" });
+        b->ArgsProduct({ { 44100, 48000, 96000, 192000 }, { 16, 64, 256, 1024, 2048 }, { 1, 2, 8 } });
+    }
+
+    template <typename SampleType>
+    std::vector<IIRFilter<SampleType>> makeFilters(typename juce::dsp::IIR::Coefficients<SampleType>::Ptr coefficients, double sampleRate, int numChannels, int blockSize)
+    {
+        juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) blockSize, 1 };
+        std::vector<IIRFilter<SampleType>> filters;
+        filters.reserve((size_t) numChannels);
+        for (int ch = 0; ch < numChannels; ch++)
+            filters.emplace_back(coefficients).prepare(spec);
+        return filters;
+    }
+}
+
+static void BiasSignalBlock(benchmark::State& state)
+{
+    const int blockSize = getBlockSize(state);
+    BiasSignal<float> bias;
+    bias.prepareToPlay(getSampleRate(state), oversamplingFactor, blockSize);
+    bias.setGain(1.f);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(bias.getNextBlock(blockSize * oversamplingFactor));
+    setNsPerSample(state, blockSize);
+}
+BENCHMARK(BiasSignalBlock)->Apply(stageArguments);
+
+static void RecordHeadGains(benchmark::State& state)
+{
+    const int blockSize = getBlockSize(state);
+    UserParameters params;
+    RecordHead<float> recHead(params);
+    recHead.prepareToPlay(getSampleRate(state), oversamplingFactor, blockSize);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(recHead.getNextGains(blockSize * oversamplingFactor));
+    setNsPerSample(state, blockSize);
+}
+BENCHMARK(RecordHeadGains)->Apply(stageArguments);
+
+// Runs fused with the record head low pass, like in the machine
+template <typename SampleType>
+static void runHysteresisBlock(benchmark::State& state, HysteresisSolver solver)
+{
+    const double sampleRate = getSampleRate(state);
+    const int blockSize = getBlockSize(state);
+    const int numChannels = getNumChannels(state);
+    const int numSamples = blockSize * oversamplingFactor;
+    UserParameters params;
+    params.solver = solver;
+    BiasSignal<SampleType> bias;
+    RecordHead<SampleType> recHead(params);
+    Hysteresis<SampleType> hysteresis(params);
+    bias.prepareToPlay(sampleRate, oversamplingFactor, blockSize);
+    recHead.prepareToPlay(sampleRate, oversamplingFactor, blockSize);
+    hysteresis.prepareToPlay(sampleRate, oversamplingFactor, numChannels, blockSize);
+    const double rate = sampleRate * oversamplingFactor;
+    auto lowPass = makeFilters<SampleType>(juce::dsp::IIR::Coefficients<SampleType>::makeLowPass(rate, (SampleType) juce::jmin(24000.0, rate * 0.45), 1), rate, numChannels, numSamples);
+
+    juce::AudioBuffer<SampleType> input(numChannels, numSamples), buffer(numChannels, numSamples);
+    fillWithNoise(input);
+    // The bias and gains are measured on their own, keep them out of this one
+    auto* biasSource = bias.getNextBlock(numSamples);
+    std::vector<SampleType> biasBlock(biasSource, biasSource + numSamples);
+    auto* gainSource = recHead.getNextGains(numSamples);
+    std::vector<SampleType> gains(gainSource, gainSource + numSamples);
+    for (auto _ : state)
+    {
+        // Fresh input every time, the copy is cheap next to the solver
+        buffer.makeCopyOf(input, true);
+        juce::dsp::AudioBlock<SampleType> block(buffer);
+        hysteresis.processBlock(block, biasBlock.data(), gains.data(), lowPass);
+        benchmark::ClobberMemory();
+    }
+    setNsPerSample(state, blockSize * numChannels);
+}
+static void HysteresisBlock(benchmark::State& state, HysteresisSolver solver) { runHysteresisBlock<float>(state, solver); }
+static void HysteresisBlockDouble(benchmark::State& state, HysteresisSolver solver) { runHysteresisBlock<double>(state, solver); }
+BENCHMARK_CAPTURE(HysteresisBlock, RK2, HysteresisSolver::RK2)->Apply(channelArguments);
+BENCHMARK_CAPTURE(HysteresisBlock, RK4, HysteresisSolver::RK4)->Apply(channelArguments);
+BENCHMARK_CAPTURE(HysteresisBlock, NewtonRaphson, HysteresisSolver::NewtonRaphson)->Apply(channelArguments);
+BENCHMARK_CAPTURE(HysteresisBlock, Eco, HysteresisSolver::Eco)->Apply(channelArguments);
+BENCHMARK_CAPTURE(HysteresisBlockDouble, RK4, HysteresisSolver::RK4)->Apply(channelArguments);
+BENCHMARK_CAPTURE(HysteresisBlockDouble, Eco, HysteresisSolver::Eco)->Apply(channelArguments);
+
+// L, L' and L'' over the range of Q the hysteresis sees, reports ns per value rather than per sample
+static void LangevinFunction(benchmark::State& state, bool table)
+{
+    using Lanes = SIMDLanes<double, juce::dsp::SIMDRegister<double>::SIMDNumElements>;
+    const auto& langevin = Langevin::get();
+    std::vector<Lanes> values(1024);
+    juce::Random random(1234);
+    for (auto& lanes : values)
+        for (size_t i = 0; i < Lanes::size; i++)
+            lanes[i] = (random.nextDouble() * 2.0 - 1.0) * Langevin::range * 1.2;
+    for (auto _ : state)
+    {
+        for (auto& Q : values)
+        {
+            Lanes L, LPrime, LPrimePrime;
+            if (table)
+                langevin.evaluate<true>(Q, L, LPrime, LPrimePrime);
+            else
+                Langevin::evaluateExact<true>(Q, L, LPrime, LPrimePrime);
+            benchmark::DoNotOptimize(L);
+            benchmark::DoNotOptimize(LPrime);
+            benchmark::DoNotOptimize(LPrimePrime);
+        }
+    }
+    setNsPerSample(state, (int) (values.size() * Lanes::size));
+    if (table)
+        state.counters["max_error"] = langevin.getMaxError();
+}
+BENCHMARK_CAPTURE(LangevinFunction, Table, true);
+BENCHMARK_CAPTURE(LangevinFunction, Exact, false);
+
+static void Oversampling(benchmark::State& state, juce::dsp::Oversampling<float>::FilterType filterType)
+{
+    const int blockSize = getBlockSize(state);
+    const int numChannels = getNumChannels(state);
+    juce::dsp::Oversampling<float> oversampling((size_t) numChannels, oversamplingOrder, filterType, false);
+    oversampling.initProcessing((size_t) blockSize);
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    fillWithNoise(buffer);
+    juce::dsp::AudioBlock<float> block(buffer);
+    for (auto _ : state)
+    {
+        auto upsampled = oversampling.processSamplesUp(block);
+        benchmark::DoNotOptimize(upsampled.getChannelPointer(0));
+        oversampling.processSamplesDown(block);
+        benchmark::ClobberMemory();
+    }
+    setNsPerSample(state, blockSize * numChannels);
+}
+BENCHMARK_CAPTURE(Oversampling, FIR, juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple)->Apply(channelArguments);
+BENCHMARK_CAPTURE(Oversampling, IIR, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR)->Apply(channelArguments);
+
+static void PlayHeadBlock(benchmark::State& state)
+{
+    const double sampleRate = getSampleRate(state);
+    const int blockSize = getBlockSize(state);
+    const int numChannels = getNumChannels(state);
+    UserParameters params;
+    PlayHead<float> playHead(params);
+    playHead.prepareToPlay(sampleRate);
+    auto highPass = makeFilters<float>(juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 35.f), sampleRate, numChannels, blockSize);
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    fillWithNoise(buffer);
+    juce::dsp::AudioBlock<float> block(buffer);
+    for (auto _ : state)
+    {
+        playHead.processBlock(block, highPass);
+        benchmark::ClobberMemory();
+    }
+    setNsPerSample(state, blockSize * numChannels);
+}
+BENCHMARK(PlayHeadBlock)->Apply(channelArguments);
+
+static void LossEffectFilterBlock(benchmark::State& state)
+{
+    const int blockSize = getBlockSize(state);
+    const int numChannels = getNumChannels(state);
+    UserParameters params;
+    LossEffectFilter<float> lossEffects(params);
+    lossEffects.prepareToPlay(getSampleRate(state), numChannels, blockSize);
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    fillWithNoise(buffer);
+    juce::dsp::AudioBlock<float> block(buffer);
+    for (auto _ : state)
+    {
+        lossEffects.processBlock(block);
+        benchmark::ClobberMemory();
+    }
+    setNsPerSample(state, blockSize * numChannels);
+}
+BENCHMARK(LossEffectFilterBlock)->Apply(channelArguments);
+
+// Reported per call, the kernel only depends on the sample rate and the filter order
+static void LossEffectFilterCoefficients(benchmark::State& state)
+{
+    UserParameters params;
+    params.lossFilterOrder = (int) state.range(1);
+    LossEffectFilter<float> lossEffects(params);
+    lossEffects.prepareToPlay(getSampleRate(state), 1, 512);
+    for (auto _ : state)
+        lossEffects.rebuildCoefficients();
+}
+BENCHMARK(LossEffectFilterCoefficients)
+    ->ArgNames({ "rate", "order" })
+    ->ArgsProduct({ { 44100, 48000, 96000, 192000 }, { 1 << 7, 1 << 9, 1 << 11 } })
+    ->Unit(benchmark::kMicrosecond);
+
+static void ModDelayBlock(benchmark::State& state)
+{
+    const int blockSize = getBlockSize(state);
+    const int numChannels = getNumChannels(state);
+    UserParameters params;
+    params.flutterRate = 5.f;
+    params.flutterDepth = 0.5f;
+    params.wowRate = 0.5f;
+    params.wowDepth = 0.01f;
+    params.scrapeFlutter = 0.002f;
+    ModDelay<float> flutter(params);
+    flutter.prepareToPlay(getSampleRate(state), numChannels, blockSize);
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    fillWithNoise(buffer);
+    juce::dsp::AudioBlock<float> block(buffer);
+    for (auto _ : state)
+    {
+        flutter.processBlock(block);
+        benchmark::ClobberMemory();
+    }
+    setNsPerSample(state, blockSize * numChannels);
+}
+BENCHMARK(ModDelayBlock)->Apply(channelArguments);
+
+template <typename SampleType>
+static void runTapeMachineBlock(benchmark::State& state, HysteresisSolver solver, int numChannels, int subBlockSize = TapeMachine<SampleType>::defaultSubBlockSize)
+{
+    const int blockSize = getBlockSize(state);
+    TapeMachine<SampleType> tapeMachine;
+    tapeMachine.setMaxSubBlockSize(subBlockSize);
+    auto& params = tapeMachine.getUserParams();
+    params.solver = solver;
+    params.flutterRate = 5.f;
+    params.flutterDepth = 0.5f;
+    params.wowRate = 0.5f;
+    params.wowDepth = 0.01f;
+    params.scrapeFlutter = 0.002f;
+    tapeMachine.prepareToPlay(getSampleRate(state), numChannels, blockSize);
+    juce::AudioBuffer<SampleType> input(numChannels, blockSize), buffer(numChannels, blockSize);
+    fillWithNoise(input);
+    for (auto _ : state)
+    {
+        // Keeps the hysteresis from settling into silence or saturation, the copy is cheap next to the machine
+        buffer.makeCopyOf(input, true);
+        juce::dsp::AudioBlock<SampleType> block(buffer);
+        tapeMachine.processBlock(block);
+        benchmark::ClobberMemory();
+    }
+    setNsPerSample(state, blockSize * numChannels);
+}
+static void TapeMachineBlock(benchmark::State& state, HysteresisSolver solver) { runTapeMachineBlock<float>(state, solver, getNumChannels(state)); }
+static void TapeMachineBlockDouble(benchmark::State& state, HysteresisSolver solver) { runTapeMachineBlock<double>(state, solver, getNumChannels(state)); }
+BENCHMARK_CAPTURE(TapeMachineBlock, RK2, HysteresisSolver::RK2)->Apply(channelArguments);
+BENCHMARK_CAPTURE(TapeMachineBlock, RK4, HysteresisSolver::RK4)->Apply(channelArguments);
+BENCHMARK_CAPTURE(TapeMachineBlock, NewtonRaphson, HysteresisSolver::NewtonRaphson)->Apply(channelArguments);
+BENCHMARK_CAPTURE(TapeMachineBlock, Eco, HysteresisSolver::Eco)->Apply(channelArguments);
+BENCHMARK_CAPTURE(TapeMachineBlockDouble, RK4, HysteresisSolver::RK4)->Apply(channelArguments);
+BENCHMARK_CAPTURE(TapeMachineBlockDouble, Eco, HysteresisSolver::Eco)->Apply(channelArguments);
+
+// Large host blocks, to find the sub-block size where the oversampled buffers fall out of cache
+static void TapeMachineSubBlock(benchmark::State& state) { runTapeMachineBlock<float>(state, HysteresisSolver::RK2, 2, (int) state.range(2)); }
+BENCHMARK(TapeMachineSubBlock)->ArgNames({ "rate", "block", "subblock" })->ArgsProduct({ { 48000 }, { 2048, 8192 }, { 32, 64, 128, 256, 512, 2048 } });
+
+static void TapeMachineSilence(benchmark::State& state)
+{
+    const int blockSize = getBlockSize(state);
+    const int numChannels = getNumChannels(state);
+    TapeMachine<float> tapeMachine;
+    tapeMachine.prepareToPlay(getSampleRate(state), numChannels, blockSize);
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    buffer.clear();
+    juce::dsp::AudioBlock<float> block(buffer);
+    // Runs out the tail, after which the machine skips its blocks
+    for (int i = 0; i <= tapeMachine.getSettlingTimeInSamples() / blockSize + 1; i++)
+        tapeMachine.processBlock(block);
+    if (! tapeMachine.isIdle())
+        state.SkipWithError("The machine didn't go idle");
+    for (auto _ : state)
+    {
+        tapeMachine.processBlock(block);
+        benchmark::ClobberMemory();
+    }
+    setNsPerSample(state, blockSize * numChannels);
+}
+BENCHMARK(TapeMachineSilence)->Apply(channelArguments);
+
+int main(int argc, char** argv)
+{
+    // Same as the audio thread of the plugin, decaying feedback would otherwise end up in denormals
+    juce::ScopedNoDenormals noDenormals;
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+    Created: 17 Oct 2026 5:02:51pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include <iostream>
+#include "BatchRenderer.h"
+
+BatchRenderer::BatchRenderer(const RenderSettings& settings, int numWorkers)
+    : settings(settings), scheduler(numWorkers)
+{
+    formatManager.registerBasicFormats();
+    // Decoding and encoding is cheap next to the tape machine, a few threads keep up with many workers
+    const int numIOThreads = juce::jmax(1, scheduler.getNumWorkers() / 4);
+    for (int i = 0; i < numIOThreads; i++)
+    {
+        auto* thread = ioThreads.add(new juce::TimeSliceThread("Render I/O " + juce::String(i)));
+        thread->startThread();
+    }
+    for (int i = 0; i < scheduler.getNumWorkers(); i++)
+    {
+        auto* renderer = renderers.add(new FileRenderer(settings));
+        renderer->setIOThread(ioThreads[i % numIOThreads]);
+    }
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    scheduler.waitUntilDone();
+    for (auto* thread : ioThreads)
+        thread->stopThread(-1);
+}
+
+int BatchRenderer::render(const juce::Array<juce::File>& inputs, const juce::Array<juce::File>& outputs)
+{
+    jassert(inputs.size() == outputs.size());
+    numFailed = 0;
+    for (int i = 0; i < inputs.size(); i++)
+    {
+        const juce::File input = inputs[i];
+        const juce::File output = outputs[i];
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        if (channelsPerJob > 0 || segmentLength > 0)
+            reader.reset(formatManager.createReaderFor(input));
+        if (reader != nullptr && segmentLength > 0 && reader->lengthInSamples >= 2 * (juce::int64) (segmentLength * reader->sampleRate))
+            addSegmentJobs(input, output, reader->sampleRate, reader->lengthInSamples);
+        else if (reader != nullptr && channelsPerJob > 0 && (int) reader->numChannels > channelsPerJob)
+            addChannelJobs(input, output, (int) reader->numChannels);
+        else
+            scheduler.addJob([this, input, output] (int worker)
+            {
+                report(input, output, renderers[worker]->render(input, output, {}));
+            });
+    }
+    scheduler.waitUntilDone();
+    return numFailed;
+}
+
+std::shared_ptr<BatchRenderer::SplitFile> BatchRenderer::createSplitFile(const juce::File& input, const juce::File& output, int numParts)
+{
+    auto file = std::make_shared<SplitFile>();
+    file->input = input;
+    file->output = output;
+    for (int part = 0; part < numParts; part++)
+        file->parts.add(output.getSiblingFile(output.getFileNameWithoutExtension() + ".part" + juce::String(part) + ".wav"));
+    file->remainingParts = numParts;
+    return file;
+}
+
+void BatchRenderer::addChannelJobs(const juce::File& input, const juce::File& output, int numChannels)
+{
+    auto file = createSplitFile(input, output, (numChannels + channelsPerJob - 1) / channelsPerJob);
+    file->combine = [file = file.get()] (FileRenderer& renderer) { return renderer.merge(file->input, file->parts, file->output); };
+    for (int part = 0; part < file->parts.size(); part++)
+    {
+        FileRenderer::Options options;
+        options.firstChannel = part * channelsPerJob;
+        options.numChannels = juce::jmin(channelsPerJob, numChannels - options.firstChannel);
+        addPartJob(file, part, options);
+    }
+}
+
+void BatchRenderer::addSegmentJobs(const juce::File& input, const juce::File& output, double sampleRate, juce::int64 length)
+{
+    const auto segmentSamples = (juce::int64) (segmentLength * sampleRate);
+    const int crossfadeSamples = juce::jmax(0, juce::roundToInt(crossfade * sampleRate));
+    const int numSegments = (int) ((length + segmentSamples - 1) / segmentSamples);
+    auto file = createSplitFile(input, output, numSegments);
+    file->combine = [file = file.get(), crossfadeSamples] (FileRenderer& renderer)
+    {
+        return renderer.stitch(file->input, file->parts, crossfadeSamples, file->output);
+    };
+    for (int part = 0; part < numSegments; part++)
+    {
+        FileRenderer::Options options;
+        options.start = part * segmentSamples;
+        // Every segment but the last runs on into the next one for the crossfade
+        options.length = juce::jmin(segmentSamples, length - options.start) + (part < numSegments - 1 ? crossfadeSamples : 0);
+        options.warmUp = (juce::int64) (warmUp * sampleRate);
+        addPartJob(file, part, options);
+    }
+}
+
+void BatchRenderer::addPartJob(std::shared_ptr<SplitFile> file, int part, const FileRenderer::Options& options)
+{
+    scheduler.addJob([this, file, part, options] (int worker)
+    {
+        // Float parts, so combining them doesn't lose resolution
+        auto partOptions = options;
+        partOptions.bitDepth = 32;
+        auto result = renderers[worker]->render(file->input, file->parts[part], partOptions);
+        if (result.failed())
+        {
+            file->failed = true;
+            std::lock_guard<std::mutex> lock(logLock);
+            std::cerr << result.getErrorMessage() << std::endl;
+        }
+        finishPart(worker, *file);
+    });
+}
+
+void BatchRenderer::finishPart(int worker, SplitFile& file)
+{
+    if (--file.remainingParts > 0)
+        return;
+    auto result = file.failed ? juce::Result::fail("Rendering " + file.input.getFullPathName() + " failed")
+                              : file.combine(*renderers[worker]);
+    for (auto& part : file.parts)
+        part.deleteFile();
+    report(file.input, file.output, result);
+}
+
+void BatchRenderer::report(const juce::File& input, const juce::File& output, const juce::Result& result)
+{
+    std::lock_guard<std::mutex> lock(logLock);
+    if (result.failed())
+    {
+        numFailed++;
+        std::cerr << result.getErrorMessage() << std::endl;
+    }
+    else
+        std::cout << input.getFileName() << " -> " << output.getFullPathName() << std::endl;
+}
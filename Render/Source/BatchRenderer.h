@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+    Created: 17 Oct 2026 5:02:51pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FileRenderer.h"
+#include "JobScheduler.h"
+
+/** Renders many files at once.
+
+    Every worker of the scheduler owns one FileRenderer, so there is one tape
+    machine and one block buffer per worker no matter how many files are queued.
+    Disk reads and writes run on a few shared I/O threads while the workers
+    process audio.
+
+    Files with more channels than the channels per job are split: each group of
+    channels is rendered as its own job into a temporary file next to the output,
+    and the job that finishes last merges them.
+
+    Long files can instead be cut into segments along time. Each segment starts
+    early by a warm-up so the tape machine has settled into the state a render from
+    the start of the file would have, and overlaps the next one by a short
+    crossfade that hides what difference remains.
+*/
+class BatchRenderer
+{
+public:
+    BatchRenderer(const RenderSettings& settings, int numWorkers);
+    ~BatchRenderer();
+    // 0 renders every file as a single job
+    void setChannelsPerJob(int numChannels) { channelsPerJob = numChannels; };
+    // Files longer than two segments are cut into segments of about this length, 0 never cuts. Takes precedence over channel groups.
+    void setSegmentLength(double seconds) { segmentLength = seconds; };
+    // Minimum warm-up of every segment, the tape machine's settling time is used when it's longer
+    void setWarmUp(double seconds) { warmUp = seconds; };
+    void setCrossfade(double seconds) { crossfade = seconds; };
+    // Renders inputs[i] to outputs[i] and returns how many of them failed
+    int render(const juce::Array<juce::File>& inputs, const juce::Array<juce::File>& outputs);
+private:
+    struct SplitFile
+    {
+        juce::File input;
+        juce::File output;
+        juce::Array<juce::File> parts;
+        std::atomic<int> remainingParts { 0 };
+        std::atomic<bool> failed { false };
+        // Turns the parts into the output once they are all rendered
+        std::function<juce::Result (FileRenderer&)> combine;
+    };
+
+    std::shared_ptr<SplitFile> createSplitFile(const juce::File& input, const juce::File& output, int numParts);
+    void addChannelJobs(const juce::File& input, const juce::File& output, int numChannels);
+    void addSegmentJobs(const juce::File& input, const juce::File& output, double sampleRate, juce::int64 length);
+    void addPartJob(std::shared_ptr<SplitFile> file, int part, const FileRenderer::Options& options);
+    void finishPart(int worker, SplitFile& file);
+    void report(const juce::File& input, const juce::File& output, const juce::Result& result);
+
+    const RenderSettings& settings;
+    int channelsPerJob = 0;
+    double segmentLength = 0;
+    double warmUp = 0;
+    double crossfade = 0.01;
+    juce::AudioFormatManager formatManager;
+    juce::OwnedArray<juce::TimeSliceThread> ioThreads;
+    juce::OwnedArray<FileRenderer> renderers;
+    std::atomic<int> numFailed { 0 };
+    std::mutex logLock;
+    // Destroyed first, so no job outlives the renderers
+    JobScheduler scheduler;
+};
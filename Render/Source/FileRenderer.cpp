@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    FileRenderer.cpp
+    Created: 17 Oct 2026 3:40:18pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "FileRenderer.h"
+
+namespace
+{
+    // Writing starts by deleting the output, so it must never resolve to the file being read
+    bool isSameFile(const juce::File& a, const juce::File& b)
+    {
+        return a.getLinkedTarget() == b.getLinkedTarget();
+    }
+}
+
+FileRenderer::FileRenderer(const RenderSettings& settings) : settings(settings)
+{
+    // WAV, AIFF and FLAC, plus whatever else the platform provides
+    formatManager.registerBasicFormats();
+}
+
+juce::Result FileRenderer::render(const juce::File& input, const juce::File& output, const Options& options)
+{
+    if (isSameFile(input, output))
+        return juce::Result::fail("Refusing to overwrite the input " + input.getFullPathName());
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+    if (reader == nullptr)
+        return juce::Result::fail("Could not read " + input.getFullPathName());
+
+    const int numInputChannels = (int) reader->numChannels;
+    const int firstChannel = options.firstChannel;
+    const int numChannels = options.numChannels == 0 ? numInputChannels - firstChannel : options.numChannels;
+    if (firstChannel < 0 || numChannels <= 0 || firstChannel + numChannels > numInputChannels)
+        return juce::Result::fail("Invalid channel range for " + input.getFullPathName());
+    if (options.start < 0 || options.start > reader->lengthInSamples)
+        return juce::Result::fail("Invalid range for " + input.getFullPathName());
+    const int blockSize = juce::jmax(1, settings.blockSize);
+
+    juce::String error;
+    auto writer = createWriter(output, *reader, numChannels, options.bitDepth, error);
+    if (writer == nullptr)
+        return juce::Result::fail(error);
+
+    const double sampleRate = reader->sampleRate;
+    const juce::int64 remaining = reader->lengthInSamples - options.start;
+    const juce::int64 length = options.length < 0 ? remaining : juce::jmin(options.length, remaining);
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> threadedWriter;
+    if (ioThread != nullptr)
+    {
+        // About a second of read ahead and write behind keeps the disk busy while the tape machine runs
+        const int samplesToBuffer = juce::jmax(blockSize * 4, juce::roundToInt(sampleRate));
+        auto* bufferingReader = new juce::BufferingAudioReader(reader.release(), *ioThread, samplesToBuffer);
+        bufferingReader->setReadTimeout(-1);
+        reader.reset(bufferingReader);
+        threadedWriter = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(writer.release(), *ioThread, samplesToBuffer);
+    }
+
+    tapeMachine.getUserParams() = settings.params;
+    tapeMachine.getBiasSignal().setGain(settings.biasGain);
+    tapeMachine.setOfflineRender(settings.offlineHighQuality);
+    tapeMachine.setNonRealtime(true);
+    tapeMachine.prepareToPlay(sampleRate, numChannels, blockSize);
+    // Start early enough for the state of the machine to match a render from the beginning of the file
+    const juce::int64 warmUp = juce::jmax(options.warmUp, (juce::int64) tapeMachine.getSettlingTimeInSamples());
+    const juce::int64 runStart = juce::jmax((juce::int64) 0, options.start - warmUp);
+    tapeMachine.setTimelinePosition(runStart);
+    // Keeps its allocation when the next file is smaller
+    buffer.setSize(numInputChannels, blockSize, false, false, true);
+
+    // Drop the pre-roll and the first latency samples of the output. Past the end of the
+    // input the reader returns zeros, which makes up for the latency at the end.
+    juce::int64 samplesToSkip = tapeMachine.getLatencyInSamples() + (options.start - runStart);
+    juce::int64 readPosition = runStart;
+    juce::int64 written = 0;
+    while (written < length)
+    {
+        // Reads past the end of the file are filled with silence
+        reader->read(&buffer, 0, blockSize, readPosition, true, true);
+        readPosition += blockSize;
+        auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock((size_t) firstChannel, (size_t) numChannels);
+        tapeMachine.processBlock(block);
+
+        const int skipped = (int) juce::jmin(samplesToSkip, (juce::int64) blockSize);
+        samplesToSkip -= skipped;
+        const int numToWrite = (int) juce::jmin((juce::int64) (blockSize - skipped), length - written);
+        if (numToWrite > 0 && ! write(writer.get(), threadedWriter.get(), firstChannel, numChannels, skipped, numToWrite))
+            return juce::Result::fail("Writing " + output.getFullPathName() + " failed");
+        written += numToWrite;
+    }
+    // Deleting the threaded writer flushes whatever is still queued
+    threadedWriter.reset();
+    return juce::Result::ok();
+}
+
+bool FileRenderer::write(juce::AudioFormatWriter* writer, juce::AudioFormatWriter::ThreadedWriter* threadedWriter,
+                                 int firstChannel, int numChannels, int startSample, int numSamples)
+{
+    channelPointers.resize((size_t) numChannels);
+    for (int ch = 0; ch < numChannels; ch++)
+        channelPointers[(size_t) ch] = buffer.getReadPointer(firstChannel + ch, startSample);
+
+    if (threadedWriter == nullptr)
+        return writer->writeFromFloatArrays(channelPointers.data(), numChannels, numSamples);
+
+    // The queue refuses blocks while it is full, wait for the I/O thread to catch up
+    while (! threadedWriter->write(channelPointers.data(), numSamples))
+        juce::Thread::sleep(1);
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatWriter> FileRenderer::createWriter(const juce::File& output, const juce::AudioFormatReader& source,
+                                                                    int numChannels, int bitDepth, juce::String& error)
+{
+    auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+    if (format == nullptr)
+    {
+        error = "Unsupported output format " + output.getFullPathName();
+        return nullptr;
+    }
+    if (bitDepth == 0)
+        bitDepth = (int) source.bitsPerSample;
+    if (! format->getPossibleBitDepths().contains(bitDepth))
+        bitDepth = 24;
+
+    // FileOutputStream appends to existing files
+    output.deleteFile();
+    auto stream = output.createOutputStream();
+    if (stream == nullptr || ! stream->openedOk())
+    {
+        error = "Could not write " + output.getFullPathName();
+        return nullptr;
+    }
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), source.sampleRate, (unsigned int) numChannels,
+                                                                            bitDepth, source.metadataValues, 0));
+    if (writer == nullptr)
+        error = "Could not create a writer for " + output.getFullPathName();
+    else
+        stream.release(); // The writer owns the stream now
+    return writer;
+}
+
+juce::Result FileRenderer::merge(const juce::File& input, const juce::Array<juce::File>& parts, const juce::File& output)
+{
+    if (isSameFile(input, output))
+        return juce::Result::fail("Refusing to overwrite the input " + input.getFullPathName());
+    std::unique_ptr<juce::AudioFormatReader> source(formatManager.createReaderFor(input));
+    if (source == nullptr)
+        return juce::Result::fail("Could not read " + input.getFullPathName());
+    juce::OwnedArray<juce::AudioFormatReader> readers;
+    int numChannels = 0;
+    for (auto& part : parts)
+    {
+        auto* reader = readers.add(formatManager.createReaderFor(part));
+        if (reader == nullptr)
+            return juce::Result::fail("Could not read " + part.getFullPathName());
+        numChannels += (int) reader->numChannels;
+    }
+
+    juce::String error;
+    auto writer = createWriter(output, *source, numChannels, 0, error);
+    if (writer == nullptr)
+        return juce::Result::fail(error);
+
+    const int blockSize = juce::jmax(1, settings.blockSize);
+    buffer.setSize(numChannels, blockSize, false, false, true);
+    channelPointers.resize((size_t) numChannels);
+    const juce::int64 length = source->lengthInSamples;
+    for (juce::int64 position = 0; position < length; position += blockSize)
+    {
+        const int numSamples = (int) juce::jmin((juce::int64) blockSize, length - position);
+        int channel = 0;
+        for (auto* reader : readers)
+        {
+            reader->read(buffer.getArrayOfWritePointers() + channel, (int) reader->numChannels, position, numSamples);
+            channel += (int) reader->numChannels;
+        }
+        for (int ch = 0; ch < numChannels; ch++)
+            channelPointers[(size_t) ch] = buffer.getReadPointer(ch);
+        if (! writer->writeFromFloatArrays(channelPointers.data(), numChannels, numSamples))
+            return juce::Result::fail("Writing " + output.getFullPathName() + " failed");
+    }
+    return juce::Result::ok();
+}
+
+juce::Result FileRenderer::stitch(const juce::File& input, const juce::Array<juce::File>& parts, int crossfadeLength, const juce::File& output)
+{
+    if (isSameFile(input, output))
+        return juce::Result::fail("Refusing to overwrite the input " + input.getFullPathName());
+    std::unique_ptr<juce::AudioFormatReader> source(formatManager.createReaderFor(input));
+    if (source == nullptr)
+        return juce::Result::fail("Could not read " + input.getFullPathName());
+    juce::OwnedArray<juce::AudioFormatReader> readers;
+    for (auto& part : parts)
+        if (readers.add(formatManager.createReaderFor(part)) == nullptr)
+            return juce::Result::fail("Could not read " + part.getFullPathName());
+
+    const int numChannels = (int) source->numChannels;
+    juce::String error;
+    auto writer = createWriter(output, *source, numChannels, 0, error);
+    if (writer == nullptr)
+        return juce::Result::fail(error);
+
+    const int blockSize = juce::jmax(1, settings.blockSize);
+    buffer.setSize(numChannels, blockSize, false, false, true);
+    crossfadeBuffer.setSize(numChannels, blockSize, false, false, true);
+    auto writeBuffer = [&] (int numSamples)
+    {
+        return writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+    };
+
+    for (int i = 0; i < readers.size(); i++)
+    {
+        auto* reader = readers[i];
+        const bool isLast = i == readers.size() - 1;
+        // The start of every part but the first went out with the previous crossfade
+        const juce::int64 bodyStart = i == 0 ? 0 : crossfadeLength;
+        const juce::int64 bodyEnd = reader->lengthInSamples - (isLast ? 0 : crossfadeLength);
+        for (juce::int64 position = bodyStart; position < bodyEnd; position += blockSize)
+        {
+            const int numSamples = (int) juce::jmin((juce::int64) blockSize, bodyEnd - position);
+            reader->read(&buffer, 0, numSamples, position, true, true);
+            if (! writeBuffer(numSamples))
+                return juce::Result::fail("Writing " + output.getFullPathName() + " failed");
+        }
+        if (isLast)
+            break;
+
+        // Both segments have warmed up and almost agree, so the gains add up to one rather than the power
+        auto* next = readers[i + 1];
+        for (int offset = 0; offset < crossfadeLength; offset += blockSize)
+        {
+            const int numSamples = juce::jmin(blockSize, crossfadeLength - offset);
+            reader->read(&buffer, 0, numSamples, bodyEnd + offset, true, true);
+            next->read(&crossfadeBuffer, 0, numSamples, offset, true, true);
+            for (int ch = 0; ch < numChannels; ch++)
+            {
+                auto* out = buffer.getWritePointer(ch);
+                auto* in = crossfadeBuffer.getReadPointer(ch);
+                for (int n = 0; n < numSamples; n++)
+                {
+                    const float fadeIn = (float) (offset + n + 1) / (float) (crossfadeLength + 1);
+                    out[n] += (in[n] - out[n]) * fadeIn;
+                }
+            }
+            if (! writeBuffer(numSamples))
+                return juce::Result::fail("Writing " + output.getFullPathName() + " failed");
+        }
+    }
+    return juce::Result::ok();
+}
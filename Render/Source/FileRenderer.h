@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    FileRenderer.h
+    Created: 17 Oct 2026 3:40:18pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/TapeSim.h"
+#include "RenderSettings.h"
+
+/** Runs audio files through a tape machine without a host.
+
+    Files are streamed in blocks of RenderSettings::blockSize, so memory use
+    doesn't depend on the length of the file. The output is compensated for the
+    latency of the tape machine and has the same length as the input.
+*/
+class FileRenderer
+{
+public:
+    struct Options
+    {
+        // Channels to render, all of them if numChannels is 0
+        int firstChannel = 0;
+        int numChannels = 0;
+        // 0 keeps the input's bit depth where the output format supports it
+        int bitDepth = 0;
+        // The output holds samples [start, start + length) of the rendered file, a negative length goes to the end
+        juce::int64 start = 0;
+        juce::int64 length = -1;
+        // Minimum pre-roll before start, the tape machine's own settling time is used when it's longer
+        juce::int64 warmUp = 0;
+    };
+
+    FileRenderer(const RenderSettings& settings);
+    juce::Result render(const juce::File& input, const juce::File& output, const Options& options);
+    // Interleaves the channels of parts, in order, into output with the bit depth and metadata of input
+    juce::Result merge(const juce::File& input, const juce::Array<juce::File>& parts, const juce::File& output);
+    /** Joins consecutive segments of input into output. Every part but the last overlaps
+        the next by crossfadeLength samples, the overlap is crossfaded.
+    */
+    juce::Result stitch(const juce::File& input, const juce::Array<juce::File>& parts, int crossfadeLength, const juce::File& output);
+    // Reads ahead and writes behind on this thread while the tape machine runs. Without one, I/O happens inline.
+    void setIOThread(juce::TimeSliceThread* thread) { ioThread = thread; };
+private:
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& output, const juce::AudioFormatReader& source,
+                                                          int numChannels, int bitDepth, juce::String& error);
+    // Writes through threadedWriter if there is one, otherwise through writer
+    bool write(juce::AudioFormatWriter* writer, juce::AudioFormatWriter::ThreadedWriter* threadedWriter,
+                       int firstChannel, int numChannels, int startSample, int numSamples);
+
+    const RenderSettings& settings;
+    juce::AudioFormatManager formatManager;
+    juce::TimeSliceThread* ioThread = nullptr;
+    juce::AudioBuffer<float> buffer;
+    juce::AudioBuffer<float> crossfadeBuffer;
+    std::vector<const float*> channelPointers;
+    // Prepared again for every file, which resets all of its state
+    TapeMachine<float> tapeMachine;
+};
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    JobScheduler.cpp
+    Created: 17 Oct 2026 5:02:51pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "JobScheduler.h"
+
+namespace
+{
+    // Index of the worker running on this thread, -1 on other threads
+    thread_local int currentWorker = -1;
+}
+
+JobScheduler::Worker::Worker(JobScheduler& owner, int index)
+    : juce::Thread("Render worker " + juce::String(index)), owner(owner), index(index)
+{
+}
+
+JobScheduler::JobScheduler(int numWorkers)
+{
+    for (int i = 0; i < juce::jmax(1, numWorkers); i++)
+        workers.add(new Worker(*this, i));
+    for (auto* worker : workers)
+        worker->startThread();
+}
+
+JobScheduler::~JobScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateLock);
+        exiting = true;
+    }
+    jobAdded.notify_all();
+    for (auto* worker : workers)
+        worker->stopThread(-1);
+}
+
+void JobScheduler::addJob(Job job)
+{
+    const int index = currentWorker >= 0 ? currentWorker : nextQueue++ % workers.size();
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->queueLock);
+        workers[index]->queue.push_back(std::move(job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateLock);
+        queuedJobs++;
+        unfinishedJobs++;
+    }
+    jobAdded.notify_one();
+}
+
+void JobScheduler::waitUntilDone()
+{
+    std::unique_lock<std::mutex> lock(stateLock);
+    allDone.wait(lock, [this] { return unfinishedJobs == 0; });
+}
+
+bool JobScheduler::takeJob(int index, Job& job)
+{
+    {
+        auto* own = workers[index];
+        std::lock_guard<std::mutex> lock(own->queueLock);
+        if (! own->queue.empty())
+        {
+            job = std::move(own->queue.back());
+            own->queue.pop_back();
+            return true;
+        }
+    }
+    for (int offset = 1; offset < workers.size(); offset++)
+    {
+        auto* victim = workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim->queueLock);
+        if (! victim->queue.empty())
+        {
+            job = std::move(victim->queue.front());
+            victim->queue.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobScheduler::runWorker(int index)
+{
+    currentWorker = index;
+    for (;;)
+    {
+        Job job;
+        if (takeJob(index, job))
+        {
+            {
+                std::lock_guard<std::mutex> lock(stateLock);
+                queuedJobs--;
+            }
+            job(index);
+            bool finished;
+            {
+                std::lock_guard<std::mutex> lock(stateLock);
+                finished = --unfinishedJobs == 0;
+            }
+            if (finished)
+                allDone.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(stateLock);
+        jobAdded.wait(lock, [this] { return queuedJobs > 0 || exiting; });
+        if (exiting)
+            return;
+    }
+}
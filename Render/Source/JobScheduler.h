@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    JobScheduler.h
+    Created: 17 Oct 2026 5:02:51pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+#include <condition_variable>
+
+/** Runs jobs on a fixed set of worker threads with work stealing.
+
+    Every worker has its own queue. Jobs added from outside are spread over the
+    queues, jobs added by a running job go to the queue of its worker. A worker
+    takes the newest job from its own queue and, once that is empty, steals the
+    oldest job of another worker. Jobs are passed the index of the worker running
+    them, so they can use resources that belong to that worker.
+*/
+class JobScheduler
+{
+public:
+    using Job = std::function<void (int worker)>;
+
+    JobScheduler(int numWorkers);
+    ~JobScheduler();
+    int getNumWorkers() const { return workers.size(); };
+    void addJob(Job job);
+    // Blocks until every job, including the ones added while waiting, has finished
+    void waitUntilDone();
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(JobScheduler& owner, int index);
+        void run() override { owner.runWorker(index); };
+        std::mutex queueLock;
+        std::deque<Job> queue;
+    private:
+        JobScheduler& owner;
+        const int index;
+    };
+
+    void runWorker(int index);
+    bool takeJob(int index, Job& job);
+
+    juce::OwnedArray<Worker> workers;
+    std::atomic<int> nextQueue { 0 };
+    // Guards the counters below, the workers sleep on it while there is nothing to do
+    std::mutex stateLock;
+    std::condition_variable jobAdded;
+    std::condition_variable allDone;
+    int queuedJobs = 0;
+    int unfinishedJobs = 0;
+    bool exiting = false;
+};
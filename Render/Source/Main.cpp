@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 3:40:18pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BatchRenderer.h"
+
+namespace
+{
+    RenderSettings parseSettings(const juce::ArgumentList& args)
+    {
+        RenderSettings settings;
+        if (args.containsOption("--preset"))
+        {
+            auto result = settings.loadPreset(args.getExistingFileForOption("--preset"));
+            if (result.failed())
+                juce::ConsoleApplication::fail(result.getErrorMessage());
+        }
+        if (args.containsOption("--block-size"))
+            settings.blockSize = args.getValueForOption("--block-size").getIntValue();
+        if (settings.blockSize <= 0)
+            juce::ConsoleApplication::fail("The block size must be positive");
+        return settings;
+    }
+
+    juce::Array<juce::File> getInputFiles(const juce::ArgumentList& args)
+    {
+        juce::Array<juce::File> files;
+        for (auto& arg : args.arguments)
+            if (! arg.isOption())
+                files.add(arg.resolveAsFile());
+        return files;
+    }
+
+    // Every output is deleted before it is written, so none may be an input or shared by two inputs
+    void checkOutputs(const juce::Array<juce::File>& inputs, const juce::Array<juce::File>& outputs)
+    {
+        for (int i = 0; i < outputs.size(); i++)
+        {
+            const auto output = outputs[i].getLinkedTarget();
+            for (auto& input : inputs)
+                if (output == input.getLinkedTarget())
+                    juce::ConsoleApplication::fail("The output " + outputs[i].getFullPathName() + " is also an input");
+            for (int j = 0; j < i; j++)
+                if (output == outputs[j].getLinkedTarget())
+                    juce::ConsoleApplication::fail("More than one input would be rendered to " + outputs[i].getFullPathName());
+        }
+    }
+
+    void render(const juce::ArgumentList& args)
+    {
+        const RenderSettings settings = parseSettings(args);
+        auto inputs = getInputFiles(args);
+        juce::Array<juce::File> outputs;
+        if (args.containsOption("--output-dir"))
+        {
+            auto directory = args.getFileForOption("--output-dir");
+            if (! directory.createDirectory())
+                juce::ConsoleApplication::fail("Could not create " + directory.getFullPathName());
+            for (auto& input : inputs)
+                outputs.add(directory.getChildFile(input.getFileName()));
+        }
+        else
+        {
+            if (inputs.size() != 2)
+                juce::ConsoleApplication::fail("Expected an input and an output file, or --output-dir");
+            outputs.add(inputs.getLast());
+            inputs.removeLast();
+        }
+        if (inputs.isEmpty())
+            juce::ConsoleApplication::fail("No input files");
+        checkOutputs(inputs, outputs);
+
+        int numJobs = juce::Thread::getNumCpus();
+        if (args.containsOption("--jobs"))
+            numJobs = args.getValueForOption("--jobs").getIntValue();
+        if (numJobs <= 0)
+            juce::ConsoleApplication::fail("The number of jobs must be positive");
+
+        BatchRenderer renderer(settings, numJobs);
+        if (args.containsOption("--channels-per-job"))
+            renderer.setChannelsPerJob(juce::jmax(0, args.getValueForOption("--channels-per-job").getIntValue()));
+        if (args.containsOption("--segment-length"))
+            renderer.setSegmentLength(juce::jmax(0.0, args.getValueForOption("--segment-length").getDoubleValue()));
+        if (args.containsOption("--warm-up"))
+            renderer.setWarmUp(juce::jmax(0.0, args.getValueForOption("--warm-up").getDoubleValue()));
+        if (args.containsOption("--crossfade"))
+            renderer.setCrossfade(juce::jmax(0.0, args.getValueForOption("--crossfade").getDoubleValue()));
+        const int numFailed = renderer.render(inputs, outputs);
+        if (numFailed > 0)
+            juce::ConsoleApplication::fail(juce::String(numFailed) + " of " + juce::String(inputs.size()) + " files failed");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "Renders audio files through the tape machine.", true);
+    app.addDefaultCommand({ "",
+                            "[--preset=<file>] [--block-size=<n>] [--jobs=<n>] [--channels-per-job=<n>] [--segment-length=<s>] [--warm-up=<s>] [--crossfade=<s>]\n"
+                            "    <input> <output> | --output-dir=<dir> <inputs...>",
+                            "Renders files through the tape machine",
+                            "The preset uses the plugin's parameter IDs. Files are streamed block by block,\n"
+                            "WAV, AIFF and FLAC are supported for input and output.\n"
+                            "--jobs sets the number of worker threads, one per core by default. Files with more\n"
+                            "channels than --channels-per-job are split into groups that render in parallel.\n"
+                            "Files longer than two --segment-length seconds are cut into segments that render in\n"
+                            "parallel. Each segment pre-rolls at least --warm-up seconds, or the tape machine's\n"
+                            "settling time if that is longer, and is crossfaded over --crossfade seconds (0.01).",
+                            render });
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    RenderSettings.cpp
+    Created: 17 Oct 2026 3:40:18pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "RenderSettings.h"
+
+juce::Result RenderSettings::loadPreset(const juce::File& file)
+{
+    auto xml = juce::parseXML(file);
+    if (xml == nullptr)
+        return juce::Result::fail("Could not parse preset " + file.getFullPathName());
+
+    for (auto* param : xml->getChildWithTagNameIterator("PARAM"))
+    {
+        const juce::String id = param->getStringAttribute("id");
+        const float value = (float) param->getDoubleAttribute("value");
+        if (id == "INPUT_GAIN")                 params.inputGain = value;
+        else if (id == "HEAD_GAP")              params.gapWidth = value;
+        else if (id == "HEAD_TAPE_SPACING")     params.spacingTapeHead = value;
+        else if (id == "TAPE_THICKNESS")        params.tapeThickness = value;
+        else if (id == "TAPE_SPEED")            params.tapeSpeed = value;
+        else if (id == "OUTPUT_GAIN")           params.outputGain = value;
+        else if (id == "DRIVE")                 params.drive = value;
+        else if (id == "QUALITY")               params.solver = static_cast<HysteresisSolver>(juce::roundToInt(value));
+        else if (id == "BIAS_GAIN")             biasGain = value;
+        else if (id == "FLUTTER_RATE")          params.flutterRate = value;
+        else if (id == "FLUTTER_DEPTH")         params.flutterDepth = value;
+        else if (id == "WOW_RATE")              params.wowRate = value;
+        else if (id == "WOW_DEPTH")             params.wowDepth = value;
+        else if (id == "SCRAPE_FLUTTER")        params.scrapeFlutter = value;
+        else if (id == "FLUTTER_INTERPOLATION") params.flutterInterpolation = static_cast<DelayInterpolation>(juce::roundToInt(value));
+        else if (id == "OVERSAMPLING")          params.oversampling = juce::roundToInt(value);
+        else if (id == "OVERSAMPLING_FILTER")   params.oversamplingFilter = static_cast<OversamplingFilter>(juce::roundToInt(value));
+        else if (id == "OFFLINE_HQ")            offlineHighQuality = value > 0.5f;
+        // Parameters the tape machine doesn't use yet are accepted, anything else is a typo
+        else if (id != "WIRE_TURNS" && id != "HEAD_EFFICIENCY")
+            return juce::Result::fail("Unknown parameter " + id + " in " + file.getFullPathName());
+    }
+    return juce::Result::ok();
+}
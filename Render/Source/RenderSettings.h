@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    RenderSettings.h
+    Created: 17 Oct 2026 3:40:18pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/Parameters.h"
+
+/** Everything the renderer needs to set up a tape machine, defaults match the plugin. */
+struct RenderSettings
+{
+    UserParameters params;
+    float biasGain = 1.f;
+    bool offlineHighQuality = true;
+    // Samples per block the files are streamed in
+    int blockSize = 512;
+
+    /** Reads parameter values from a preset file.
+
+        The preset uses the plugin's parameter IDs and the layout of its state:
+        <PARAMETERS><PARAM id="DRIVE" value="0.7"/>...</PARAMETERS>.
+        Parameters that aren't listed keep their current value.
+    */
+    juce::Result loadPreset(const juce::File& file);
+};
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    Convolver.cpp
+    Created: 17 Oct 2026 9:41:12am
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "Convolver.h"
+
+template <typename SampleType>
+PartitionedConvolver<SampleType>::Kernel::Kernel(const float* impulseResponse, int length, int partitionSize)
+    : length(length), partitionSize(partitionSize)
+{
+    numPartitions = juce::jmax(1, (length + partitionSize - 1) / partitionSize);
+    head.assign(partitionSize, 0);
+    std::copy(impulseResponse, impulseResponse + juce::jmin(length, partitionSize), head.begin());
+
+    const int numBins = partitionSize + 1;
+    tailSpectra.assign((numPartitions - 1) * numBins, {});
+    juce::dsp::FFT partitionFft(juce::roundToInt(std::log2(partitionSize * 2)));
+    std::vector<float> buffer(partitionSize * 4);
+    for (int p = 1; p < numPartitions; p++)
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.f);
+        const int start = p * partitionSize;
+        const int count = juce::jmin(partitionSize, length - start);
+        std::copy(impulseResponse + start, impulseResponse + start + count, buffer.begin());
+        partitionFft.performRealOnlyForwardTransform(buffer.data(), true);
+        auto spectrum = reinterpret_cast<std::complex<float>*>(buffer.data());
+        std::copy(spectrum, spectrum + numBins, tailSpectra.begin() + (p - 1) * numBins);
+    }
+}
+
+template <typename SampleType>
+void PartitionedConvolver<SampleType>::prepare(int partitionSize, int maxKernelLength)
+{
+    jassert(juce::isPowerOfTwo(partitionSize));
+    this->partitionSize = partitionSize;
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(partitionSize * 2)));
+    numSlots = juce::jmax(0, (maxKernelLength + partitionSize - 1) / partitionSize - 1);
+    history.resize(partitionSize * 2);
+    inputFrame.resize(partitionSize * 2);
+    fftBuffer.resize(partitionSize * 4);
+    tail.resize(partitionSize);
+    spectra.resize(numSlots * (partitionSize + 1));
+    reset();
+}
+
+template <typename SampleType>
+void PartitionedConvolver<SampleType>::reset()
+{
+    std::fill(history.begin(), history.end(), SampleType());
+    std::fill(inputFrame.begin(), inputFrame.end(), SampleType());
+    std::fill(tail.begin(), tail.end(), SampleType());
+    std::fill(spectra.begin(), spectra.end(), std::complex<float>());
+    historyPos = partitionSize - 1;
+    inputPos = 0;
+    slot = 0;
+}
+
+template <typename SampleType>
+void PartitionedConvolver<SampleType>::process(SampleType* data, int numSamples)
+{
+    if (kernel == nullptr)
+        return;
+    const SampleType* h = kernel->head.data();
+    int i = 0;
+    while (i < numSamples)
+    {
+        const int todo = juce::jmin(numSamples - i, partitionSize - inputPos);
+        for (int s = 0; s < todo; s++)
+        {
+            const SampleType x = data[i + s];
+            history[historyPos] = x;
+            history[historyPos + partitionSize] = x;
+            // history[historyPos + k] holds the input from k samples ago
+            const SampleType* past = history.data() + historyPos;
+            SampleType y = 0;
+            for (int k = 0; k < partitionSize; k++)
+                y += h[k] * past[k];
+            if (--historyPos < 0)
+                historyPos = partitionSize - 1;
+            inputFrame[partitionSize + inputPos + s] = x;
+            data[i + s] = y + tail[inputPos + s];
+        }
+        inputPos += todo;
+        i += todo;
+        if (inputPos == partitionSize)
+        {
+            processPartitions();
+            inputPos = 0;
+        }
+    }
+}
+
+template <typename SampleType>
+void PartitionedConvolver<SampleType>::processPartitions()
+{
+    const int numBins = partitionSize + 1;
+    const int tailPartitions = juce::jmin(kernel->numPartitions - 1, numSlots);
+    if (numSlots == 0)
+    {
+        std::copy(inputFrame.begin() + partitionSize, inputFrame.end(), inputFrame.begin());
+        return;
+    }
+
+    // Spectrum of the last two input blocks goes into the frequency domain delay line
+    std::copy(inputFrame.begin(), inputFrame.end(), fftBuffer.begin());
+    std::fill(fftBuffer.begin() + partitionSize * 2, fftBuffer.end(), 0.f);
+    fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+    slot = (slot + 1) % numSlots;
+    auto spectrum = reinterpret_cast<std::complex<float>*>(fftBuffer.data());
+    std::copy(spectrum, spectrum + numBins, spectra.begin() + slot * numBins);
+    std::copy(inputFrame.begin() + partitionSize, inputFrame.end(), inputFrame.begin());
+
+    // Partition p + 1 of the kernel meets the input block p blocks before the newest one.
+    // The result is the contribution of all but the first partition to the next block.
+    std::fill(spectrum, spectrum + partitionSize * 2, std::complex<float>());
+    for (int p = 0; p < tailPartitions; p++)
+    {
+        const auto* X = spectra.data() + ((slot - p + numSlots) % numSlots) * numBins;
+        const auto* H = kernel->tailSpectra.data() + p * numBins;
+        for (int bin = 0; bin < numBins; bin++)
+            spectrum[bin] += X[bin] * H[bin];
+    }
+    fft->performRealOnlyInverseTransform(fftBuffer.data());
+    std::copy(fftBuffer.begin() + partitionSize, fftBuffer.begin() + partitionSize * 2, tail.begin());
+}
+
+template class PartitionedConvolver<float>;
+template class PartitionedConvolver<double>;
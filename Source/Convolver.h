@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    Convolver.h
+    Created: 17 Oct 2026 9:41:12am
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Uniformly partitioned overlap-save convolver.
+
+    The first partition is convolved directly so the convolver adds no latency,
+    all further partitions are convolved in the frequency domain once per partition.
+    juce::dsp::FFT only works in float, so with double samples the direct part and the
+    overlap run in double and the partitions go through the FFT in float.
+*/
+template <typename SampleType>
+class PartitionedConvolver
+{
+public:
+    /** Frequency domain representation of an impulse response. Built off the audio thread. */
+    class Kernel : public juce::ReferenceCountedObject
+    {
+    public:
+        using Ptr = juce::ReferenceCountedObjectPtr<Kernel>;
+        Kernel(const float* impulseResponse, int length, int partitionSize);
+        int getLength() const { return length; };
+        int getNumPartitions() const { return numPartitions; };
+    private:
+        friend class PartitionedConvolver;
+        int length;
+        int partitionSize;
+        int numPartitions;
+        std::vector<SampleType> head;
+        std::vector<std::complex<float>> tailSpectra;
+    };
+
+    void prepare(int partitionSize, int maxKernelLength);
+    void reset();
+    void setKernel(Kernel* newKernel) { if (kernel.get() != newKernel) kernel = newKernel; };
+    Kernel* getKernel() const { return kernel.get(); };
+    void process(SampleType* data, int numSamples);
+private:
+    void processPartitions();
+
+    int partitionSize = 0;
+    int numSlots = 0;
+    int slot = 0;
+    int historyPos = 0;
+    int inputPos = 0;
+    typename Kernel::Ptr kernel;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<SampleType> history;
+    std::vector<SampleType> inputFrame;
+    std::vector<float> fftBuffer;
+    std::vector<SampleType> tail;
+    std::vector<std::complex<float>> spectra;
+};
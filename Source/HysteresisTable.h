@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    HysteresisTable.h
+    Created: 18 Oct 2026 12:24:17am
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SIMDLanes.h"
+#include "HysteresisTableData.h"
+
+/** The memoryless surrogate of the hysteresis behind the eco solver.
+
+    The model's dM/dH depends on M and H only through Q = (H + alpha M) / a and on
+    the direction of the field, and falling at Q is rising at -Q mirrored. Holding
+    the alpha M part of Q over a step, the change of M is the difference of the
+    integral of dM/dH at the Q before and after it. That integral is tabulated by
+    Tools/hysteresis-table from the exact model, so a step of any size costs two
+    lookups whatever the signal does.
+
+    The nodes are uniform in u = Q / (1 + |Q| / compression), which packs the slowly
+    changing saturation into few nodes. Beyond the last node the field no longer
+    moves M.
+*/
+class HysteresisTable
+{
+public:
+    // Integral of dM/dH over H while rising, from Q = 0 to Q, per lane
+    template <typename T, size_t N>
+    static SIMDLanes<T, N> getIntegral(const SIMDLanes<T, N>& Q);
+
+    // Q where the nodes are spaced u apart
+    static double getQ(double u) { return u / (1.0 - std::abs(u) / HysteresisTableData::compression); };
+    // dQ/du at u
+    static double getQSlope(double u) { const double d = 1.0 - std::abs(u) / HysteresisTableData::compression; return 1.0 / (d * d); };
+    // u of node i, the middle node is Q = 0
+    static double getNodeU(int i) { return (double) (i - HysteresisTableData::numNodes / 2) / HysteresisTableData::nodesPerUnit; };
+    // The slope over Q the table was built with at node i, to check it against the model
+    static double getNodeSlope(int i) { return HysteresisTableData::nodes[i][1] / getQSlope(getNodeU(i)); };
+    static constexpr double maxU = (double) (HysteresisTableData::numNodes / 2) / HysteresisTableData::nodesPerUnit;
+};
+
+template <typename T, size_t N>
+SIMDLanes<T, N> HysteresisTable::getIntegral(const SIMDLanes<T, N>& Q)
+{
+    using namespace HysteresisTableData;
+    constexpr T step = (T) 1 / nodesPerUnit;
+    constexpr T limit = (T) maxU;
+    SIMDLanes<T, N> result;
+    for (size_t i = 0; i < N; i++)
+    {
+        const T u = juce::jlimit(-limit, limit, Q.v[i] / (1 + std::abs(Q.v[i]) / (T) compression));
+        // jlimit passes NaN through, which would make the index undefined. It stays NaN,
+        // the hysteresis maps it to M = 0.
+        if (u != u)
+        {
+            result.v[i] = u;
+            continue;
+        }
+        const T position = (u + limit) * nodesPerUnit;
+        const int index = juce::jmin((int) position, numNodes - 2);
+        const T t = position - (T) index;
+        const double* y0 = nodes[index];
+        const double* y1 = nodes[index + 1];
+        // Cubic Hermite on the integral and its slope over u
+        const T t2 = t * t;
+        const T t3 = t2 * t;
+        const T h01 = 3 * t2 - 2 * t3;
+        const T h00 = 1 - h01;
+        const T h10 = (t3 - 2 * t2 + t) * step;
+        const T h11 = (t3 - t2) * step;
+        result.v[i] = h00 * (T) y0[0] + h10 * (T) y0[1] + h01 * (T) y1[0] + h11 * (T) y1[1];
+    }
+    return result;
+}
@@ -0,0 +1,520 @@
+/*
+  ==============================================================================
+
+    HysteresisTableData.h
+    Generated by Tools/hysteresis-table, don't edit
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace HysteresisTableData
+{
+    constexpr double compression = 16.0;
+    constexpr int nodesPerUnit = 16;
+    constexpr int numNodes = 499;
+    // The integral and its slope over u at u = (i - numNodes / 2) / nodesPerUnit
+    constexpr double nodes[numNodes][2] =
+    {
+        { -59441.722449124922, 245.6734601634418 },
+        { -59426.305944158521, 247.6586932199607 },
+        { -59410.764609121841, 249.66808736148892 },
+        { -59395.096921686774, 251.70203624442232 },
+        { -59379.301334670592, 253.76094159268541 },
+        { -59363.376275526549, 255.84521336392257 },
+        { -59347.320145822036, 257.95526997816404 },
+        { -59331.13132070376, 260.09153851753121 },
+        { -59314.808148349475, 262.25445494007641 },
+        { -59298.348949406245, 264.44446431036459 },
+        { -59281.75201641435, 266.66202102031639 },
+        { -59265.015613216914, 268.90758902455565 },
+        { -59248.137974354388, 271.18164209373742 },
+        { -59231.11730444376, 273.48466405320471 },
+        { -59213.951777541864, 275.81714904540934 },
+        { -59196.63953649233, 278.17960179402507 },
+        { -59179.178692255824, 280.57253787819462 },
+        { -59161.567323222851, 282.99648400990236 },
+        { -59143.803474508793, 285.45197833034928 },
+        { -59125.885157230477, 287.93957070318817 },
+        { -59107.810347763872, 290.45982302417877 },
+        { -59089.576986982203, 293.0133095395081 },
+        { -59071.18297947391, 295.600617170703 },
+        { -59052.626192739881, 298.22234585471347 },
+        { -59033.904456369288, 300.87910888948954 },
+        { -59015.015561193279, 303.57153329368236 },
+        { -58995.957258415983, 306.30026017634941 },
+        { -58976.727258721956, 309.06594511900983 },
+        { -58957.323231359449, 311.8692585691187 },
+        { -58937.742803198642, 314.71088624623866 },
+        { -58917.98355776407, 317.59152956180895 },
+        { -58898.043034240451, 320.51190605224497 },
+        { -58877.918726450989, 323.47274982499499 },
+        { -58857.608081807324, 326.47481202118894 },
+        { -58837.108500230148, 329.51886129050246 },
+        { -58816.417333039586, 332.60568428479536 },
+        { -58795.531881814299, 335.73608616517231 },
+        { -58774.449397218305, 338.9108911281071 },
+        { -58753.167077794438, 342.13094294686618 },
+        { -58731.682068723334, 345.39710553364222 },
+        { -58709.991460546771, 348.71026351756598 },
+        { -58688.092287854211, 352.07132284518963 },
+        { -58665.981527931246, 355.48121139905618 },
+        { -58643.656099368694, 358.94087963778571 },
+        { -58621.112860630972, 362.45130125998764 },
+        { -58598.348608582353, 366.01347388770927 },
+        { -58575.360076969679, 369.62841977673622 },
+        { -58552.143934860003, 373.29718654902831 },
+        { -58528.696785031585, 377.02084795274442 },
+        { -58505.015162316609, 380.80050464715509 },
+        { -58481.095531893945, 384.63728501708323 },
+        { -58456.934287530174, 388.53234601416358 },
+        { -58432.52774976701, 392.48687402993187 },
+        { -58407.872164053282, 396.50208579895656 },
+        { -58382.963698819382, 400.579229335104 },
+        { -58357.798443492189, 404.71958490133136 },
+        { -58332.372406448289, 408.92446601501592 },
+        { -58306.681512903189, 413.19522048977251 },
+        { -58280.721602734258, 417.53323151584448 },
+        { -58254.488428234894, 421.93991878018977 },
+        { -58227.977651797402, 426.41673962788576 },
+        { -58201.184843521922, 430.9651902678666 },
+        { -58174.105478748614, 435.58680702264394 },
+        { -58146.734935510256, 440.28316762644675 },
+        { -58119.068491902195, 445.05589257121551 },
+        { -58091.101323366565, 449.90664650558324 },
+        { -58062.828499887422, 454.83713968588734 },
+        { -58034.244983093413, 459.84912948456196 },
+        { -58005.345623264431, 464.94442195583844 },
+        { -57976.12515623845, 470.12487346338418 },
+        { -57946.578200214659, 475.3923923714836 },
+        { -57916.699252448881, 480.74894080245991 },
+        { -57886.482685836942, 486.19653646469459 },
+        { -57855.922745381533, 491.73725455287774 },
+        { -57825.013544537971, 497.37322972462312 },
+        { -57793.749061433897, 503.10665815695938 },
+        { -57762.12313495791, 508.93979968629088 },
+        { -57730.129460711716, 514.87498003558608 },
+        { -57697.761586820241, 520.91459313311532 },
+        { -57665.012909593861, 527.06110352671567 },
+        { -57631.876669036617, 533.31704889878381 },
+        { -57598.345944194021, 539.68504268607501 },
+        { -57564.413648333655, 546.16777680961991 },
+        { -57530.072523951618, 552.76802452022685 },
+        { -57495.315137597339, 559.48864336511463 },
+        { -57460.133874509069, 566.33257828149306 },
+        { -57424.52093305187, 573.30286482348072 },
+        { -57388.468318949599, 580.40263252857858 },
+        { -57351.96783930192, 587.63510843160191 },
+        { -57315.011096376933, 595.00362073228291 },
+        { -57277.589481169562, 602.51160262495512 },
+        { -57239.694166715279, 610.16259629881699 },
+        { -57201.316101148317, 617.96025711665402 },
+        { -57162.446000492819, 625.90835798202363 },
+        { -57123.074341174979, 634.01079390400469 },
+        { -57083.191352243368, 642.27158677063289 },
+        { -57042.787007284183, 650.6948903407681 },
+        { -57001.851016017325, 659.28499546733792 },
+        { -56960.372815558527, 668.04633556299905 },
+        { -56918.341561331908, 676.98349232192857 },
+        { -56875.746117616611, 686.10120171148048 },
+        { -56832.57504771011, 695.40436024797305 },
+        { -56788.816603690015, 704.89803157255096 },
+        { -56744.458715755085, 714.58745334326977 },
+        { -56699.488981125134, 724.47804446128623 },
+        { -56653.894652478411, 734.57541264946326 },
+        { -56607.662625903744, 744.8853624031201 },
+        { -56560.779428343638, 755.41390333450647 },
+        { -56513.231204502918, 766.16725893267687 },
+        { -56465.0037031963, 777.15187576328128 },
+        { -56416.082263106582, 788.37443313298195 },
+        { -56366.451797923553, 799.84185324671034 },
+        { -56316.096780831998, 811.5613118845024 },
+        { -56265.001228315268, 823.5402496312314 },
+        { -56213.148683238927, 835.78638369045814 },
+        { -56160.522197176899, 848.30772031734932 },
+        { -56107.104311940166, 861.11256790899779 },
+        { -56052.877040265797, 874.20955079162286 },
+        { -55997.821845621409, 887.60762374692672 },
+        { -55941.919621077395, 901.31608732404243 },
+        { -55885.15066719638, 915.34460398598173 },
+        { -55827.494668886087, 929.70321514172974 },
+        { -55768.93067115856, 944.40235912179105 },
+        { -55709.437053734873, 959.4528901561921 },
+        { -55648.991504430785, 974.86609841904135 },
+        { -55587.570991254397, 990.65373120946322 },
+        { -55525.1517331426, 1006.8280153438175 },
+        { -55461.709169258196, 1023.4016808358496 },
+        { -55397.217926764373, 1040.3879859543065 },
+        { -55331.651786987823, 1057.8007437471013 },
+        { -55264.983649875627, 1075.6543501312617 },
+        { -55197.185496644837, 1093.9638136566346 },
+        { -55128.228350516591, 1112.7447870562198 },
+        { -55058.082235419308, 1132.0136007068118 },
+        { -54986.716132537469, 1151.7872981330943 },
+        { -54914.097934573794, 1172.0836736980682 },
+        { -54840.194397583517, 1192.9213126339132 },
+        { -54764.971090229265, 1214.319633579913 },
+        { -54688.392340294347, 1236.298933805683 },
+        { -54610.42117828066, 1258.8804373148876 },
+        { -54531.019277904765, 1282.0863460352725 },
+        { -54450.146893292243, 1305.9398943226356 },
+        { -54367.762792655849, 1330.4654070180704 },
+        { -54283.824188227169, 1355.6883613222021 },
+        { -54198.286662194725, 1381.6354527651104 },
+        { -54111.104088383014, 1408.3346655766688 },
+        { -54022.22854938759, 1435.815347781331 },
+        { -53931.610248859964, 1464.1082913675259 },
+        { -53839.197418613665, 1493.2458179072021 },
+        { -53744.93622019836, 1523.2618700272667 },
+        { -53648.770640563016, 1554.1921091630054 },
+        { -53550.642381401238, 1586.0740200530049 },
+        { -53450.490741742418, 1618.9470224642735 },
+        { -53348.252493320615, 1652.8525906670748 },
+        { -53243.861748219882, 1687.8343812089595 },
+        { -53137.249818259304, 1723.9383695686897 },
+        { -53028.345065543923, 1761.2129962975009 },
+        { -52917.07274356881, 1799.7093232860273 },
+        { -52803.354828222902, 1839.4812008160538 },
+        { -52687.109837997392, 1880.5854460797818 },
+        { -52568.252642660089, 1923.0820338644137 },
+        { -52446.69425961352, 1967.0343001080453 },
+        { -52322.341637110083, 2012.5091590343704 },
+        { -52195.097423453757, 2059.5773345629113 },
+        { -52064.859721274981, 2108.3136066674692 },
+        { -51931.521825924312, 2158.7970733171055 },
+        { -51794.971946992722, 2211.1114285727126 },
+        { -51655.092911932894, 2265.3452573320224 },
+        { -51511.761850728471, 2321.5923471030555 },
+        { -51364.849860538634, 2379.952017046141 },
+        { -51214.221649235849, 2440.5294643434372 },
+        { -51059.735156757648, 2503.4361277307621 },
+        { -50901.241153212002, 2568.7900677533253 },
+        { -50738.582812713059, 2636.716362977978 },
+        { -50571.595261984272, 2707.347520994912 },
+        { -50400.105102852816, 2780.8239025786929 },
+        { -50223.929907878031, 2857.2941568247679 },
+        { -50042.877688512475, 2936.9156644402101 },
+        { -49856.746335393167, 3019.854985626333 },
+        { -49665.323030609092, 3106.2883081432828 },
+        { -49468.383632096316, 3196.4018901797681 },
+        { -49265.692030681457, 3290.3924915584207 },
+        { -49056.999480736413, 3388.4677855786208 },
+        { -48842.043905930252, 3490.8467424305632 },
+        { -48620.549182177499, 3597.7599735997364 },
+        { -48392.224400594547, 3709.4500250152187 },
+        { -48156.763114097055, 3826.1716048873932 },
+        { -47913.842572210138, 3948.1917302239194 },
+        { -47663.122949728218, 4075.7897739273094 },
+        { -47404.246576060796, 4209.2573921757721 },
+        { -47136.837173440457, 4348.8983094912228 },
+        { -46860.499113654841, 4495.0279365463284 },
+        { -46574.816704597935, 4647.9727933919266 },
+        { -46279.353519716395, 4808.0697084569383 },
+        { -45973.651785349801, 4975.664761455896 },
+        { -45657.23184301969, 5151.1119363181379 },
+        { -45329.591705895793, 5334.7714485321449 },
+        { -44990.206730936246, 5527.0077100008648 },
+        { -44638.529430531533, 5728.1868937695481 },
+        { -44273.989449838635, 5938.6740609800881 },
+        { -43895.993738322068, 6158.8298133027502 },
+        { -43503.926946258762, 6389.0064361039504 },
+        { -43097.152079038693, 6629.5435009335497 },
+        { -42675.011443913048, 6880.7629007903624 },
+        { -42236.827925302445, 7142.9632982757603 },
+        { -41781.906625761439, 7416.413975401646 },
+        { -41309.53691007007, 7701.3480846866241 },
+        { -40818.994889544389, 7997.95531443855 },
+        { -40309.546382371896, 8306.3739969077596 },
+        { -39780.450383424162, 8626.6827063772689 },
+        { -39230.963073415856, 8958.8914151986537 },
+        { -38660.342392310529, 9302.9322991564841 },
+        { -38067.853195374948, 9658.6503090603128 },
+        { -37452.773002134061, 10025.793652686589 },
+        { -36814.39833859077, 10404.0043594863 },
+        { -36152.051661405436, 10792.809129010702 },
+        { -35465.088839296797, 11191.610691735761 },
+        { -34752.907151817009, 11599.679936636723 },
+        { -34014.953749041648, 12016.149082021348 },
+        { -33250.734497870159, 12440.006183172291 },
+        { -32459.823121926471, 12870.091280549985 },
+        { -31641.870522965011, 13305.094493929144 },
+        { -30796.614152814262, 13743.556359193439 },
+        { -29923.88728691807, 14183.870684093066 },
+        { -29023.6280342391, 14624.290165886498 },
+        { -28095.887904505427, 15062.934966695993 },
+        { -27140.839743375371, 15497.804381450107 },
+        { -26158.784839920361, 15926.791659017059 },
+        { -25150.159009674822, 16347.701950917188 },
+        { -24115.537461057782, 16758.273266055996 },
+        { -23055.638263748788, 17156.200207335867 },
+        { -21971.324254898413, 17539.160160666677 },
+        { -20863.603242903879, 17904.841503351792 },
+        { -19733.626398616467, 18250.973302081373 },
+        { -18582.684759682517, 18575.355886005291 },
+        { -17412.203814345619, 18875.891612622625 },
+        { -16223.736175244178, 19150.615098080158 },
+        { -15018.952400055654, 19397.72216260737 },
+        { -13799.630062599146, 19615.596748807897 },
+        { -12567.641223428314, 19802.835106480245 },
+        { -11324.938491221283, 19958.266602138374 },
+        { -10073.539903676559, 20080.970602333695 },
+        { -8815.5128876068975, 20170.288993650858 },
+        { -7552.9575812098165, 20225.834033821251 },
+        { -6287.9898161546453, 20247.491371768938 },
+        { -5022.7240626324583, 20235.418222837096 },
+        { -3759.2566367665659, 20190.036832024743 },
+        { -2499.6494571044022, 20112.023496111386 },
+        { -1245.9146160329915, 20002.293539022819 },
+        { 0, 19861.982738738305 },
+        { 1245.9151513819115, 20002.310735103401 },
+        { 2499.651614533268, 20112.058268316563 },
+        { 3759.261526143694, 20190.08954042348 },
+        { 5022.7328156638223, 20235.489205907874 },
+        { 6288.0035849877904, 20247.580944932626 },
+        { 7552.9775369513136, 20225.942488145225 },
+        { 8815.5402187647069, 20170.416594745217 },
+        { 10073.575814539881, 20081.117589457448 },
+        { 11324.9842001915, 19958.433187530118 },
+        { 12567.697961315407, 19803.021474924059 },
+        { 13799.699070898496, 19615.803057441004 },
+        { 15019.034929220474, 19397.948540971935 },
+        { 16223.833482968745, 19150.86164841698 },
+        { 17412.317163874282, 18876.158410400491 },
+        { 18582.81541815888, 18575.642980675417 },
+        { 19733.775635486403, 18251.280718042766 },
+        { 20863.772328385017, 17905.169241109867 },
+        { 21971.514458527567, 17539.508198164891 },
+        { 23055.850853017408, 17156.568501437676 },
+        { 24115.773700144127, 16758.661754152978 },
+        { 25150.420158279921, 16348.110552638174 },
+        { 26159.072152213277, 15927.220278012766 },
+        { 27141.154467051714, 15498.252907227999 },
+        { 28096.23127996147, 15063.403276481004 },
+        { 29024.001293862406, 14624.778126484336 },
+        { 29924.291654494067, 14184.378153734755 },
+        { 30797.050843047029, 13744.083189341494 },
+        { 31642.340741109278, 13305.64053102823 },
+        { 32460.328063526911, 12870.65636770715 },
+        { 33251.275348603172, 12440.59016175445 },
+        { 34015.531684654125, 12016.751793160041 },
+        { 34753.523338156054, 11600.301222632655 },
+        { 35465.744432423955, 11192.250397357911 },
+        { 36152.747807788743, 10793.467102686851 },
+        { 36815.136175367763, 10404.68045438387 },
+        { 37453.553657438941, 10026.487727684309 },
+        { 38068.6777887231, 9659.3622296128324 },
+        { 38661.212035033837, 9303.6619380552365 },
+        { 39231.878869142412, 8959.6386532334 },
+        { 39781.413428596388, 8627.4474329035402 },
+        { 40310.557766797305, 8307.1561103260974 },
+        { 40820.055696973737, 7998.7547225918288 },
+        { 41310.648218797942, 7702.164705182091 },
+        { 41783.069509244779, 7417.2477358643982 },
+        { 42238.043452792954, 7143.8141365404153 },
+        { 42676.280681099837, 6881.6307650375393 },
+        { 43098.476088697869, 6630.4283497776487 },
+        { 43505.306788907168, 6389.9082386384007 },
+        { 43897.430472872671, 6159.7485491086254 },
+        { 44275.484134255443, 5939.6097201036018 },
+        { 44640.083122482269, 5729.1394766736012 },
+        { 44991.820488441328, 5527.9772274953793 },
+        { 45331.266587972379, 5335.7579216875729 },
+        { 45658.968910319934, 5152.1153963660799 },
+        { 45975.45210079255, 4976.6852496804204 },
+        { 46281.218149111912, 4809.1072760798015 },
+        { 46576.74671726532, 4649.0275014545414 },
+        { 46862.495583032054, 4496.0998557909797 },
+        { 47138.901177686952, 4349.9875202437461 },
+        { 47406.379198652896, 4210.3639842315961 },
+        { 47665.325280047517, 4076.9138464425123 },
+        { 47916.115706125333, 3949.3333916126971 },
+        { 48159.108154539543, 3827.330972727148 },
+        { 48394.642458128394, 3710.6272259602415 },
+        { 48623.041375564295, 3598.9551433043275 },
+        { 48844.611362689451, 3492.0600254822566 },
+        { 49059.643337701877, 3389.6993354420606 },
+        { 49268.413434554794, 3291.6424705303202 },
+        { 49471.183739997767, 3197.6704693552788 },
+        { 49668.203010626698, 3107.5756673940477 },
+        { 49859.707367130919, 3021.1613135903808 },
+        { 50045.920963638207, 2938.2411585238524 },
+        { 50227.05663067181, 2858.6390232165577 },
+        { 50403.316490756595, 2782.1883562755256 },
+        { 50574.892546153525, 2708.7317858402744 },
+        { 50741.967238571226, 2638.1206717123741 },
+        { 50904.713981008426, 2570.2146620768676 },
+        { 51063.297662129837, 2504.8812583779363 },
+        { 51217.875123776765, 2441.9953911700277 },
+        { 51368.59561236982, 2381.4390091283312 },
+        { 51515.601205079736, 2323.1006828487057 },
+        { 51659.027211729343, 2266.8752246041604 },
+        { 51799.002553449864, 2212.6633248252724 },
+        { 51935.650119152073, 2160.371205742978 },
+        { 52069.087100891324, 2109.9102923589398 },
+        { 52199.425309208746, 2061.1969006845984 },
+        { 52326.771469521133, 2014.1519430087767 },
+        { 52451.227500612644, 1968.7006498138865 },
+        { 52572.890776253931, 1924.7723078478987 },
+        { 52691.854370940913, 1882.3000137790518 },
+        { 52808.207290707476, 1841.2204427990187 },
+        { 52922.034689925618, 1801.4736315018611 },
+        { 53033.418074963527, 1763.0027743421003 },
+        { 53142.435495528203, 1725.7540329644191 },
+        { 53249.161724475052, 1689.6763576990497 },
+        { 53353.668426822907, 1654.7213205250707 },
+        { 53456.024318669777, 1620.8429588189617 },
+        { 53556.295316662719, 1587.9976292292945 },
+        { 53654.544678634622, 1556.1438710392624 },
+        { 53750.833135981738, 1525.2422784096552 },
+        { 53845.219018318741, 1495.2553809216147 },
+        { 53937.75837091267, 1466.1475318697305 },
+        { 54028.505065363774, 1437.8848037860125 },
+        { 54117.510903969785, 1410.4348907060792 },
+        { 54204.825718180473, 1383.7670167181004 },
+        { 54290.497461521576, 1357.8518503644455 },
+        { 54374.57229734119, 1332.6614244943544 },
+        { 54457.094681707451, 1308.1690611921451 },
+        { 54538.107441763663, 1284.3493014308458 },
+        { 54617.651849825954, 1261.1778391272958 },
+        { 54695.767693488924, 1238.6314592940371 },
+        { 54772.493341986505, 1216.68798000938 },
+        { 54847.865809038332, 1195.3261979419901 },
+        { 54921.920812396245, 1174.5258371907412 },
+        { 54994.692830290878, 1154.26750121229 },
+        { 55066.215154964819, 1134.5326276306328 },
+        { 55136.519943466337, 1115.3034457335514 },
+        { 55205.638265865884, 1096.5629364777988 },
+        { 55273.600151046987, 1078.2947948365065 },
+        { 55340.434630213, 1060.4833943348135 },
+        { 55406.169778241972, 1043.1137536309625 },
+        { 55470.832753013237, 1026.1715050098287 },
+        { 55534.449832821403, 1009.6428646653507 },
+        { 55597.046451985938, 993.51460465911885 },
+        { 55658.647234757693, 977.77402644730284 },
+        { 55719.276027617292, 962.40893587684911 },
+        { 55778.955930054377, 947.40761956202823 },
+        { 55837.709323911135, 932.75882255198917 },
+        { 55895.557901368455, 918.45172721286508 },
+        { 55952.522691648141, 904.47593324973479 },
+        { 56008.624086500335, 890.82143879884848 },
+        { 56063.88186454097, 877.47862252625475 },
+        { 56118.31521450029, 864.43822667409108 },
+        { 56171.942757439858, 851.69134099700182 },
+        { 56224.782567992115, 839.22938753784979 },
+        { 56276.852194673324, 827.04410619412067 },
+        { 56328.168679317947, 815.12754102894428 },
+        { 56378.748575679616, 803.47202728482057 },
+        { 56428.607967241413, 792.07017906097917 },
+        { 56477.762484275714, 780.91487761647011 },
+        { 56526.227320191625, 769.99926026449998 },
+        { 56574.017247206008, 759.31670982730157 },
+        { 56621.146631372081, 748.8608446187593 },
+        { 56667.629446997715, 738.62550892864147 },
+        { 56713.479290483985, 728.60476398085837 },
+        { 56758.709393612779, 718.79287934173271 },
+        { 56803.332636310857, 709.1843247544989 },
+        { 56847.361558916367, 699.77376237917531 },
+        { 56890.808373972432, 690.55603941709796 },
+        { 56933.684977571327, 681.52618110133949 },
+        { 56976.002960271559, 672.67938403573646 },
+        { 57017.77361760904, 664.01100986576205 },
+        { 57059.00796022272, 655.51657926631879 },
+        { 57099.716723613921, 647.19176623183739 },
+        { 57139.910377557972, 639.03239265586114 },
+        { 57179.599135185759, 631.0344231879609 },
+        { 57218.792961752195, 623.19396035599152 },
+        { 57257.501583107871, 615.50723994453176 },
+        { 57295.734493889599, 607.97062661861844 },
+        { 57333.500965444895, 600.58060978528374 },
+        { 57370.810053505011, 593.33379968423594 },
+        { 57407.670605620624, 586.22692370129187 },
+        { 57444.091268373908, 579.25682289751774 },
+        { 57480.080494380265, 572.42044874946055 },
+        { 57515.646549092824, 565.71486009555474 },
+        { 57550.797517422376, 559.13722028423672 },
+        { 57585.541310185356, 552.68479452189717 },
+        { 57619.885670392207, 546.35494741756202 },
+        { 57653.838179388418, 540.14514072337147 },
+        { 57687.406262860437, 534.05293127031553 },
+        { 57720.597196718707, 528.07596909987558 },
+        { 57753.418112870051, 522.21199579319682 },
+        { 57785.876004891907, 516.45884300027103 },
+        { 57817.977733620944, 510.81443117264359 },
+        { 57849.730032668995, 505.2767685053837 },
+        { 57881.139513879549, 499.84395009403767 },
+        { 57912.21267273846, 494.51415731476692 },
+        { 57942.955893753147, 489.28565743694179 },
+        { 57973.375455815149, 484.15680347962268 },
+        { 58003.477537561623, 479.12603432533803 },
+        { 58033.268222752464, 474.19187510670514 },
+        { 58062.753505680499, 469.35293788314755 },
+        { 58091.939296633638, 464.60792263012576 },
+        { 58120.831427429206, 459.95561856359507 },
+        { 58149.435657042246, 455.3949058275208 },
+        { 58177.757677351474, 450.9247575773332 },
+        { 58205.803119028686, 446.54424249370476 },
+        { 58233.577557599907, 442.25252777093971 },
+        { 58261.086519709264, 438.04888262482689 },
+        { 58288.335489619836, 433.93268237801539 },
+        { 58315.329915989416, 429.90341318284453 },
+        { 58342.075218963306, 425.96067745648674 },
+        { 58368.576797631111, 422.10420010895689 },
+        { 58394.840037900125, 418.33383566176173 },
+        { 58420.870320844195, 414.64957636610035 },
+        { 58446.673031594502, 411.05156144783967 },
+        { 58472.253568847162, 407.54008762681815 },
+        { 58497.617355072442, 404.11562108033405 },
+        { 58522.769847521915, 400.77881104920402 },
+        { 58547.716550143225, 397.53050531603333 },
+        { 58572.46302652765, 394.37176782521715 },
+        { 58597.014914033825, 391.30389875689178 },
+        { 58621.377939252314, 388.32845742598715 },
+        { 58645.557935000616, 385.44728843527042 },
+        { 58669.560859067591, 382.66255159632351 },
+        { 58693.392814961022, 379.97675621797475 },
+        { 58717.0600749531, 377.39280048115597 },
+        { 58740.569105767412, 374.91401674669089 },
+        { 58763.926597309241, 372.54422381755683 },
+        { 58787.139494910414, 370.28778736623161 },
+        { 58810.215035643654, 368.1496899956046 },
+        { 58833.160789361755, 366.13561269821173 },
+        { 58855.984705238763, 364.25202985153732 },
+        { 58878.695164737917, 362.5063203591713 },
+        { 58901.301042111503, 360.90689811544502 },
+        { 58923.811773758367, 359.46336570787821 },
+        { 58946.237438036726, 358.18669617512734 },
+        { 58968.588847465908, 357.0894488044114 },
+        { 58990.877655668686, 356.18602641696498 },
+        { 59013.116481928148, 355.49298349003061 },
+        { 59035.319056889981, 355.02939688818509 },
+        { 59057.500393771552, 354.81731415071431 },
+        { 59079.676990496511, 354.88229840932257 },
+        { 59101.867069528344, 355.25409446204446 },
+        { 59124.090863924219, 355.96744776145368 },
+        { 59146.370960403015, 357.06311775611636 },
+        { 59168.732713199308, 358.58914010016537 },
+        { 59191.204746410178, 360.60241007498183 },
+        { 59213.819567788858, 363.17068411097983 },
+        { 59236.614324002679, 366.37513046714923 },
+        { 59259.631736979594, 370.31360820413477 },
+        { 59282.921274177272, 375.1049221336944 },
+        { 59306.540623988069, 380.89440035237868 },
+        { 59330.557573391874, 387.86128587065411 },
+        { 59355.052421968736, 396.22864930744555 },
+        { 59380.121120033924, 406.27685532961806 },
+        { 59405.879397725439, 418.36211700740807 },
+        { 59432.468270478159, 432.94245955882491 },
+        { 59460.061487719773, 450.61467828226375 },
+        { 59488.875775070446, 472.1679514749523 },
+        { 59519.185173858074, 498.66327230284656 },
+        { 59551.341526868651, 531.55395207702725 },
+        { 59585.804420241446, 572.87338638962433 },
+        { 59623.186098222046, 625.53668027955518 },
+        { 59664.320879979306, 693.84245565898118 },
+        { 59710.37623167206, 784.34242630216715 },
+        { 59763.037895389898, 907.42240906052621 },
+        { 59824.833880558013, 1080.3469392407831 },
+        { 59899.736191979013, 1333.5486322937761 },
+    };
+}
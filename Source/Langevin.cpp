@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    Langevin.cpp
+    Created: 17 Oct 2026 11:36:05pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "Langevin.h"
+
+namespace
+{
+    // Taylor series of coth(Q) - 1/Q, the coefficients of Q, Q^3, Q^5, ...
+    constexpr long double series[] = { 1.0L / 3.0L, -1.0L / 45.0L, 2.0L / 945.0L, -1.0L / 4725.0L,
+                                       2.0L / 93555.0L, -1382.0L / 638512875.0L };
+    // Below this the closed forms cancel too much and the series is used, its next term is far below double precision
+    constexpr long double seriesLimit = 0.1L;
+}
+
+const Langevin& Langevin::get()
+{
+    static const Langevin table;
+    return table;
+}
+
+Langevin::Langevin()
+{
+    nodes.resize((size_t) numNodes);
+    floatNodes.resize((size_t) numNodes);
+    for (int i = 0; i < numNodes; i++)
+    {
+        nodes[(size_t) i] = computeNode((double) i / nodesPerUnit);
+        for (int n = 0; n < 4; n++)
+            floatNodes[(size_t) i].d[n] = (float) nodes[(size_t) i].d[n];
+    }
+}
+
+Langevin::Node<double> Langevin::computeNode(double Q)
+{
+    const long double x = Q;
+    Node<double> node;
+    if (std::abs(x) < seriesLimit)
+    {
+        // Differentiate the series term by term
+        for (int n = 0; n < 4; n++)
+        {
+            long double sum = 0;
+            for (int k = 0; k < (int) (sizeof(series) / sizeof(series[0])); k++)
+            {
+                const int power = 2 * k + 1;
+                if (power < n)
+                    continue;
+                long double term = series[k];
+                for (int j = 0; j < n; j++)
+                    term *= (long double) (power - j);
+                sum += term * std::pow(x, (long double) (power - n));
+            }
+            node.d[n] = (double) sum;
+        }
+        return node;
+    }
+    const long double coth = 1.0L / std::tanh(x);
+    const long double cschSq = coth * coth - 1.0L;
+    const long double oneOverX = 1.0L / x;
+    const long double oneOverXSq = oneOverX * oneOverX;
+    node.d[0] = (double) (coth - oneOverX);
+    node.d[1] = (double) (oneOverXSq - cschSq);
+    node.d[2] = (double) (2.0L * coth * cschSq - 2.0L * oneOverXSq * oneOverX);
+    node.d[3] = (double) (-2.0L * cschSq * (cschSq + 2.0L * coth * coth) + 6.0L * oneOverXSq * oneOverXSq);
+    return node;
+}
+
+double Langevin::getMaxError() const
+{
+    using Lanes = SIMDLanes<double, 1>;
+    double maxError = 0;
+    // An odd number of points per node, so they fall between the nodes as well as on them.
+    // Both signs, the table only holds the positive half.
+    constexpr int pointsPerNode = 7;
+    const int numPoints = (int) (range + 4.0) * nodesPerUnit * pointsPerNode;
+    for (int i = -numPoints; i <= numPoints; i++)
+    {
+        const double Q = (double) i / (nodesPerUnit * pointsPerNode);
+        Lanes L, LPrime, LPrimePrime;
+        evaluate<true>(Lanes(Q), L, LPrime, LPrimePrime);
+        const Node<double> exact = computeNode(Q);
+        maxError = juce::jmax(maxError, std::abs(L[0] - exact.d[0]), std::abs(LPrime[0] - exact.d[1]), std::abs(LPrimePrime[0] - exact.d[2]));
+    }
+    return maxError;
+}
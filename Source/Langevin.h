@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    Langevin.h
+    Created: 17 Oct 2026 11:36:05pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SIMDLanes.h"
+
+// Set to 0 to evaluate the Langevin function with tanh instead of the table
+#ifndef TAPEPM_LANGEVIN_TABLE
+ #define TAPEPM_LANGEVIN_TABLE 1
+#endif
+
+/** The Langevin function L(Q) = coth(Q) - 1/Q and its first two derivatives.
+
+    The table holds L and its first three derivatives on a uniform grid over
+    0 <= Q < range. Each function is interpolated with a cubic Hermite through the
+    two nodes around Q, using the next derivative as the slope, so there is no
+    transcendental call and no branch around Q = 0. L is odd, so only positive Q
+    is stored. Past the range coth(Q) is 1 to double precision and the closed forms
+    are used.
+
+    Float lanes read a float copy of the table, so the float hysteresis stays in
+    float. The table is built once, by the first call to get(), which the
+    hysteresis does from its constructor. hysteresis-table --check-langevin
+    checks it against the exact formula.
+*/
+class Langevin
+{
+public:
+    static const Langevin& get();
+
+    // Writes L, L' and, withSecond, L'' of every lane
+    template <bool withSecond, typename T, size_t N>
+    void evaluate(const SIMDLanes<T, N>& Q, SIMDLanes<T, N>& L, SIMDLanes<T, N>& LPrime, SIMDLanes<T, N>& LPrimePrime) const;
+    // The reference, with tanh and a series near zero
+    template <bool withSecond, typename T, size_t N>
+    static void evaluateExact(const SIMDLanes<T, N>& Q, SIMDLanes<T, N>& L, SIMDLanes<T, N>& LPrime, SIMDLanes<T, N>& LPrimePrime);
+    // Largest difference between the table and the reference, of L, L' and L'' over +-(range + 4)
+    double getMaxError() const;
+
+    static constexpr double range = 20.0;
+    static constexpr int nodesPerUnit = 32;
+    static constexpr int numNodes = (int) range * nodesPerUnit + 1;
+private:
+    Langevin();
+    // L and its first three derivatives at one Q
+    template <typename T>
+    struct Node { T d[4]; };
+    static Node<double> computeNode(double Q);
+    template <typename T>
+    const std::vector<Node<T>>& getNodes() const;
+
+    std::vector<Node<double>> nodes;
+    std::vector<Node<float>> floatNodes;
+};
+
+template <typename T>
+const std::vector<Langevin::Node<T>>& Langevin::getNodes() const
+{
+    if constexpr (std::is_same_v<T, float>)
+        return floatNodes;
+    else
+        return nodes;
+}
+
+template <bool withSecond, typename T, size_t N>
+void Langevin::evaluate(const SIMDLanes<T, N>& Q, SIMDLanes<T, N>& L, SIMDLanes<T, N>& LPrime, SIMDLanes<T, N>& LPrimePrime) const
+{
+    constexpr T step = (T) 1 / nodesPerUnit;
+    const auto& table = getNodes<T>();
+    for (size_t i = 0; i < N; i++)
+    {
+        const T q = Q.v[i];
+        const T x = std::abs(q);
+        const T sign = q < 0 ? (T) -1 : (T) 1;
+        // NaN takes this branch as well, so it never indexes the table. It comes out as NaN,
+        // which the hysteresis maps to M = 0 as it did with tanh.
+        if (! (x < (T) range))
+        {
+            const T oneOverX = 1 / x;
+            L.v[i] = sign * (1 - oneOverX);
+            LPrime.v[i] = oneOverX * oneOverX;
+            if constexpr (withSecond)
+                LPrimePrime.v[i] = sign * -2 * oneOverX * oneOverX * oneOverX;
+            continue;
+        }
+        const T position = x * nodesPerUnit;
+        const int index = (int) position;
+        const T t = position - (T) index;
+        const T* y0 = table[(size_t) index].d;
+        const T* y1 = table[(size_t) index + 1].d;
+        // Hermite basis, the slope ones scaled by the grid step
+        const T t2 = t * t;
+        const T t3 = t2 * t;
+        const T h01 = 3 * t2 - 2 * t3;
+        const T h00 = 1 - h01;
+        const T h10 = (t3 - 2 * t2 + t) * step;
+        const T h11 = (t3 - t2) * step;
+        auto hermite = [&] (int n) { return h00 * y0[n] + h10 * y0[n + 1] + h01 * y1[n] + h11 * y1[n + 1]; };
+        // L and L'' are odd, L' is even
+        L.v[i] = sign * hermite(0);
+        LPrime.v[i] = hermite(1);
+        if constexpr (withSecond)
+            LPrimePrime.v[i] = sign * hermite(2);
+    }
+}
+
+template <bool withSecond, typename T, size_t N>
+void Langevin::evaluateExact(const SIMDLanes<T, N>& Q, SIMDLanes<T, N>& L, SIMDLanes<T, N>& LPrime, SIMDLanes<T, N>& LPrimePrime)
+{
+    using Lanes = SIMDLanes<T, N>;
+    const Lanes cothQ = 1.0 / simd::tanh(Q);
+    const Lanes oneOverQ = 1.0 / Q;
+    const Lanes oneQSq = oneOverQ * oneOverQ;
+    // Both branches are evaluated, the near zero series replaces the exact form where it would blow up
+    const Lanes isNearZero = simd::absLessThanOrEqual(Q, 10e-4);
+    L = simd::select(isNearZero, Q / 3.0, cothQ - oneOverQ);
+    LPrime = simd::select(isNearZero, Lanes(1.0 / 3.0), oneQSq - (cothQ * cothQ) + 1.0);
+    if constexpr (withSecond)
+        LPrimePrime = simd::select(isNearZero, Q * (-2.0 / 15.0), cothQ * (cothQ * cothQ - 1.0) * 2.0 - oneQSq * oneOverQ * 2.0);
+}
@@ -11,82 +11,119 @@
 #include <JuceHeader.h>
 #include "ModDelay.h"
 
-void ModDelay::prepareToPlay(double sampleRate, int samplesPerBlock)
+template <typename SampleType>
+void ModDelay<SampleType>::prepareToPlay(double sampleRate, int numChannels, int samplesPerBlock)
 {
-    lfo.setSampleRate(sampleRate);
-    lfo.setFrequency(8);
-    buffer.setSize(1, sampleRate*3);
-    this->startTimerHz(5);
+    maxExcursionSamples = (int) std::ceil(WowFlutter::getMaxExcursion() * sampleRate);
+    modulation.prepare(sampleRate, maxExcursionSamples);
+    delays.resize((size_t) samplesPerBlock);
+    // The longest delay plus the taps the cubic reads beyond it
+    const int length = juce::nextPowerOfTwo(2 * maxExcursionSamples + 4);
+    buffer.setSize(numChannels, length);
+    buffer.clear();
+    mask = length - 1;
+    allpassState.assign((size_t) numChannels, SampleType());
+    writeIndex = 0;
+    wet.reset(sampleRate, UserParameters::rampLength);
+    wet.setCurrentAndTargetValue(modulation.isActive() ? 1 : 0);
 }
 
-void ModDelay::processBlock (juce::dsp::AudioBlock<float>& audioBuffer)
+template <typename SampleType>
+void ModDelay<SampleType>::processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer)
 {
-    auto data = audioBuffer.getChannelPointer(0);
-    float mod = 0;
-    float enabled = (float)(params.flutterRate > 0);
-    float depth = params.flutterDepth * enabled;
-    for (int i = 0; i < audioBuffer.getNumSamples(); i++)
+    int numChannels = juce::jmin((int) audioBuffer.getNumChannels(), buffer.getNumChannels());
+    int numSamples = (int) audioBuffer.getNumSamples();
+
+    jassert((size_t) numSamples <= delays.size());
+    // Runs while the flutter is off too, so the modulation carries on in time when it's turned on
+    modulation.getNextBlock(delays.data(), numSamples, params.tracking);
+    wet.setTargetValue(modulation.isActive() ? 1 : 0);
+    if (! wet.isSmoothing() && wet.getTargetValue() == 0)
     {
-        mod = depth * lfo.getNextSample();
-        readRate = (1.f - depth) + mod;
-        pushSample(data[i]);
-        data[i] = getSample();
+        // Off, the input passes straight through. The line still takes it, so turning
+        // the flutter on fades over to a delayed signal that is already there.
+        write(audioBuffer, numChannels);
+        return;
     }
-}
 
-void ModDelay::pushSample(float sample)
-{
-    auto data = buffer.getWritePointer(0);
-    data[writeIndex] = sample;
-    writeIndex++;
-    if (writeIndex >= buffer.getNumSamples())
-        writeIndex = 0;
+    // While tracking, the delay swings up from none, so nothing is delayed for longer than it has to be
+    if (! params.tracking)
+        juce::FloatVectorOperations::add(delays.data(), (float) maxExcursionSamples, numSamples);
+    switch (params.flutterInterpolation)
+    {
+        case DelayInterpolation::Cubic: processBlock<DelayInterpolation::Cubic>(audioBuffer, numChannels); break;
+        case DelayInterpolation::Allpass: processBlock<DelayInterpolation::Allpass>(audioBuffer, numChannels); break;
+    }
 }
 
-float ModDelay::getSample()
+template <typename SampleType>
+void ModDelay<SampleType>::write (juce::dsp::AudioBlock<SampleType>& audioBuffer, int numChannels)
 {
-    int index = floor(fractionalReadIndex);
-    int nextIndex = index + 1;
-    float frac = fractionalReadIndex - index;
-    auto read = buffer.getReadPointer(0);
-    if (nextIndex >= buffer.getNumSamples())
-    {
-        nextIndex -= buffer.getNumSamples();
-    }
-    float sample = (1.0f - frac) * read[index] + frac * read[nextIndex];
-    fractionalReadIndex += readRate;
-    if (fractionalReadIndex >= buffer.getNumSamples())
+    int numSamples = (int) audioBuffer.getNumSamples();
+    for (int ch = 0; ch < numChannels; ch++)
     {
-        fractionalReadIndex -= buffer.getNumSamples();
+        const auto* data = audioBuffer.getChannelPointer(ch);
+        auto* line = buffer.getWritePointer(ch);
+        for (int i = 0; i < numSamples; i++)
+            line[(writeIndex + i) & mask] = data[i];
     }
-
-    return sample;
+    writeIndex = (writeIndex + numSamples) & mask;
 }
 
-void ModDelay::timerCallback()
+template <typename SampleType>
+template <DelayInterpolation interpolation>
+void ModDelay<SampleType>::processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, int numChannels)
 {
-    lfo.setFrequency(params.flutterRate);
+    int numSamples = (int) audioBuffer.getNumSamples();
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float delay = delays[i];
+        const SampleType mix = wet.getNextValue();
+        for (int ch = 0; ch < numChannels; ch++)
+        {
+            auto data = audioBuffer.getChannelPointer(ch);
+            auto line = buffer.getWritePointer(ch);
+            const SampleType dry = data[i];
+            line[writeIndex] = dry;
+            const SampleType delayed = interpolation == DelayInterpolation::Cubic ? readCubic(line, delay)
+                                                                                  : readAllpass(line, delay, allpassState[(size_t) ch]);
+            data[i] = dry + (delayed - dry) * mix;
+        }
+        writeIndex = (writeIndex + 1) & mask;
+    }
 }
 
-///////////
-///// LFO
-void LFO::setFrequency(double frequency)
+template <typename SampleType>
+SampleType ModDelay<SampleType>::readCubic(const SampleType* line, float delay) const
 {
-    freq = frequency;
-    updateIncrement();
+    // Hermite through the samples one newer and two older than the read position.
+    // At delays under a sample there is no newer sample yet, the newest stands in for it.
+    const int whole = (int) delay;
+    const SampleType frac = (SampleType) (delay - (float) whole);
+    const int index = writeIndex - whole;
+    const SampleType newer = line[(index + (whole > 0 ? 1 : 0)) & mask];
+    const SampleType x0 = line[index & mask];
+    const SampleType x1 = line[(index - 1) & mask];
+    const SampleType x2 = line[(index - 2) & mask];
+    const SampleType c1 = (SampleType) 0.5 * (x1 - newer);
+    const SampleType c2 = newer - (SampleType) 2.5 * x0 + 2 * x1 - (SampleType) 0.5 * x2;
+    const SampleType c3 = (SampleType) 0.5 * (x2 - newer) + (SampleType) 1.5 * (x0 - x1);
+    return ((c3 * frac + c2) * frac + c1) * frac + x0;
 }
 
-void LFO::setSampleRate(double sr)
+template <typename SampleType>
+SampleType ModDelay<SampleType>::readAllpass(const SampleType* line, float delay, SampleType& state) const
 {
-    samplerate = sr;
-    updateIncrement();
+    // First order Thiran allpass. The fraction is kept between 0.5 and 1.5, where the
+    // pole stays well inside the unit circle, so the delay can't go below half a sample.
+    const float clamped = juce::jmax(0.5f, delay);
+    const int whole = (int) (clamped - 0.5f);
+    const SampleType frac = (SampleType) (clamped - (float) whole);
+    const SampleType eta = (1 - frac) / (1 + frac);
+    const int index = writeIndex - whole;
+    state = eta * line[index & mask] + line[(index - 1) & mask] - eta * state;
+    return state;
 }
 
-float LFO::getNextSample()
-{
-    float value = std::sin(phase);
-    phase += phaseIncrement;
-    if (phase >= 2.0 * M_PI)
-        phase -= 2.0 * M_PI;
-    return value;
-}
+template class ModDelay<float>;
+template class ModDelay<double>;
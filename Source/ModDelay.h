@@ -12,42 +12,47 @@
 
 #include <JuceHeader.h>
 #include "Parameters.h"
+#include "WowFlutter.h"
 
-class LFO
-{
-public:
-    void setFrequency(double frequency);
-    void setSampleRate(double sr);
-    float getNextSample();
+/** Flutter as a modulated delay line.
 
-private:
-    double phase = juce::MathConstants<double>::pi;
-    double freq = 0.1;
-    double samplerate;
-    double phaseIncrement;
-
-    void updateIncrement()
-    {
-        phaseIncrement = (juce::MathConstants<double>::twoPi * freq) / samplerate;
-    }
-};
+    The delay moves around a centre of WowFlutter::getMaxExcursion as WowFlutter tells
+    it, so the line only needs twice that plus the interpolation taps. It's a power of
+    two long and indexed with a mask. The line and the interpolation run in the sample type, the
+    delays WowFlutter writes stay float.
 
-
-class ModDelay : juce::Timer
+    While every depth is zero the input passes straight through and there is no latency.
+    Turning the flutter on or off crossfades between the two over the parameter ramp.
+*/
+template <typename SampleType>
+class ModDelay
 {
 public:
-    ModDelay(UserParameters& userParams) : params(userParams) {};
-    void prepareToPlay (double sampleRate, int samplesPerBlock);
-    void processBlock (juce::dsp::AudioBlock<float>& audioBuffer);
-    void pushSample(float sample);
-    float getSample();
-    void timerCallback();
+    ModDelay(UserParameters& userParams) : modulation(userParams), params(userParams) {};
+    void prepareToPlay (double sampleRate, int numChannels, int samplesPerBlock);
+    void processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer);
+    void setTimelinePosition(juce::int64 samples) { modulation.setTimelinePosition(samples); };
+    // The delay the flutter moves around, none while it's off. While tracking it swings up from no delay instead.
+    int getLatencyInSamples() const { return params.tracking || ! modulation.isActive() ? 0 : maxExcursionSamples; };
+    int getMaxDelayInSamples() const { return 2 * maxExcursionSamples; };
 private:
-    juce::AudioBuffer<float> buffer;
+    template <DelayInterpolation interpolation>
+    void processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, int numChannels);
+    void write (juce::dsp::AudioBlock<SampleType>& audioBuffer, int numChannels);
+    SampleType readCubic(const SampleType* line, float delay) const;
+    SampleType readAllpass(const SampleType* line, float delay, SampleType& state) const;
+
+    // All channels share one tape transport, so they share the read and write positions
+    juce::AudioBuffer<SampleType> buffer;
+    int mask = 0;
     int writeIndex = 0;
-    float fractionalReadIndex = 0.f;
-    float readRate = 1.f;
-    LFO lfo;
+    // Last output of the allpass interpolator, per channel
+    std::vector<SampleType> allpassState;
+    int maxExcursionSamples = 0;
+    // How much of the output comes from the line rather than straight from the input
+    juce::SmoothedValue<SampleType> wet;
+    WowFlutter modulation;
+    // One block of delays
+    std::vector<float> delays;
     UserParameters &params;
 };
-
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    Oscillator.cpp
+    Created: 17 Oct 2026 2:12:09pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "Oscillator.h"
+
+void Oscillator::prepare(double sampleRate)
+{
+    samplerate = sampleRate;
+    updateRotation();
+}
+
+void Oscillator::setFrequency(double frequency)
+{
+    if (frequency == freq)
+        return;
+    freq = frequency;
+    updateRotation();
+}
+
+void Oscillator::setPhase(double phase)
+{
+    re = std::cos(phase);
+    im = std::sin(phase);
+}
+
+void Oscillator::updateRotation()
+{
+    // Only runs when the frequency or the rate changes, the phase carries on
+    const double increment = juce::MathConstants<double>::twoPi * freq / samplerate;
+    stepRe = std::cos(increment);
+    stepIm = std::sin(increment);
+    for (size_t lane = 0; lane < numLanes; lane++)
+    {
+        laneRe[lane] = std::cos(increment * lane);
+        laneIm[lane] = std::sin(increment * lane);
+    }
+    blockStepRe = std::cos(increment * numLanes);
+    blockStepIm = std::sin(increment * numLanes);
+}
+
+void Oscillator::normalise()
+{
+    // First order correction towards the unit circle, enough for the tiny drift of one block
+    const double gain = 1.5 - 0.5 * (re * re + im * im);
+    re *= gain;
+    im *= gain;
+}
+
+float Oscillator::getNextSample()
+{
+    const float value = (float) im;
+    const double nextRe = re * stepRe - im * stepIm;
+    im = re * stepIm + im * stepRe;
+    re = nextRe;
+    normalise();
+    return value;
+}
+
+template <typename SampleType>
+void Oscillator::getNextBlock(SampleType* destination, int numSamples)
+{
+    Lanes r = laneRe * re - laneIm * im;
+    Lanes i = laneIm * re + laneRe * im;
+    int n = 0;
+    for (; n + (int) numLanes <= numSamples; n += (int) numLanes)
+    {
+        for (size_t lane = 0; lane < numLanes; lane++)
+            destination[n + lane] = (SampleType) i[lane];
+        const Lanes nextR = r * blockStepRe - i * blockStepIm;
+        i = r * blockStepIm + i * blockStepRe;
+        r = nextR;
+    }
+    // Lane k of r and i now holds sample n + k
+    const int remaining = numSamples - n;
+    for (int lane = 0; lane < remaining; lane++)
+        destination[n + lane] = (SampleType) i[(size_t) lane];
+    re = r[(size_t) remaining];
+    im = i[(size_t) remaining];
+    normalise();
+}
+
+template void Oscillator::getNextBlock<float>(float*, int);
+template void Oscillator::getNextBlock<double>(double*, int);
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    Oscillator.h
+    Created: 17 Oct 2026 2:12:09pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SIMDLanes.h"
+
+/** Sine oscillator based on a rotating phasor.
+
+    Every sample the phasor (cos, sin) is multiplied by a fixed rotation, so no
+    trigonometric function is evaluated while running. Blocks are generated
+    several samples at a time: each lane holds the phasor a few samples ahead of
+    the previous one and all lanes are rotated together. The amplitude drift of
+    the recurrence is corrected once per block.
+*/
+class Oscillator
+{
+public:
+    void prepare(double sampleRate);
+    void setFrequency(double frequency);
+    void setPhase(double phase);
+    double getFrequency() const { return freq; };
+
+    float getNextSample();
+    // Writes the next numSamples values of the sine to destination, float or double
+    template <typename SampleType>
+    void getNextBlock(SampleType* destination, int numSamples);
+private:
+    static constexpr size_t numLanes = 4;
+    using Lanes = SIMDLanes<double, numLanes>;
+    void updateRotation();
+    void normalise();
+
+    double samplerate = 44100;
+    double freq = 0;
+    // Current phasor, cos and sin of the phase
+    double re = 1.0;
+    double im = 0.0;
+    // Rotation by one sample
+    double stepRe = 1.0;
+    double stepIm = 0.0;
+    // Rotation by 0 .. numLanes - 1 samples to fan the phasor out into lanes
+    Lanes laneRe = 1.0;
+    Lanes laneIm = 0.0;
+    // Rotation by numLanes samples
+    double blockStepRe = 1.0;
+    double blockStepIm = 0.0;
+};
@@ -10,6 +10,29 @@
 
 #pragma once
 
+// ODE solver used for the hysteresis, cheapest first. Eco is a table rather than a solver and
+// comes last so saved sessions keep their choice.
+enum class HysteresisSolver
+{
+    RK2,
+    RK4,
+    NewtonRaphson,
+    Eco
+};
+
+enum class OversamplingFilter
+{
+    FIR,
+    IIR
+};
+
+// Interpolation of the flutter delay line
+enum class DelayInterpolation
+{
+    Cubic,
+    Allpass
+};
+
 class UserParameters
 {
 public:
@@ -20,8 +43,29 @@ public:
     float inputGain = 1.f;
     float outputGain = 1.f;
     float drive = 0.5f;
+    HysteresisSolver solver = HysteresisSolver::RK4;
+    // 0 picks the factor automatically, otherwise the factor is 2^(oversampling - 1)
+    int oversampling = 5;
+    OversamplingFilter oversamplingFilter = OversamplingFilter::FIR;
+    int lossFilterOrder = 1 << 9; // Taps of the head loss filter, power of two
     // Flutter
     float flutterRate = 0.0;
     float flutterDepth = 0.0;
-    
+    float wowRate = 0.0;
+    float wowDepth = 0.0;
+    float scrapeFlutter = 0.0;
+    DelayInterpolation flutterInterpolation = DelayInterpolation::Cubic;
+    // Zero latency for monitoring: IIR oversampling, a minimum phase loss filter and flutter that starts from no delay
+    bool tracking = false;
+
+    // Gains and the flutter depth ramp to new values over this time, in seconds
+    static constexpr double rampLength = 0.02;
+    // Tops of the flutter parameter ranges
+    static constexpr float maxFlutterDepth = 0.4f;
+    static constexpr float maxWowDepth = 0.05f;
+    static constexpr float maxScrapeFlutter = 0.01f;
+    // Peak tape speed deviation at the tops of the ranges, a worn machine. One in good shape stays around 0.1 %.
+    static constexpr float maxFlutterSpeedDeviation = 0.005f;
+    static constexpr float maxWowSpeedDeviation = 0.005f;
+    static constexpr float maxScrapeSpeedDeviation = 0.001f;
 };
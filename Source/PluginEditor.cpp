@@ -14,7 +14,13 @@ TapepmAudioProcessorEditor::TapepmAudioProcessorEditor (TapepmAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
 
-    setSize (300, 500);
+#if TAPEPM_PROFILER
+    setSize (300, 950 + profilerHeight);
+    profilerFrames.resize(512);
+    startTimerHz(10);
+#else
+    setSize (300, 950);
+#endif
     addAndMakeVisible(headGapSlider);
     addAndMakeVisible(headTapeSpacingSlider);
     addAndMakeVisible(tapeThicknessSlider);
@@ -25,6 +31,9 @@ TapepmAudioProcessorEditor::TapepmAudioProcessorEditor (TapepmAudioProcessor& p)
     addAndMakeVisible(driveSlider);
     addAndMakeVisible(flutterRateSlider);
     addAndMakeVisible(flutterDepthSlider);
+    addAndMakeVisible(wowRateSlider);
+    addAndMakeVisible(wowDepthSlider);
+    addAndMakeVisible(scrapeFlutterSlider);
     
     headGapSlider.setName("Head Gap");
     headGapSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
@@ -47,6 +56,12 @@ TapepmAudioProcessorEditor::TapepmAudioProcessorEditor (TapepmAudioProcessor& p)
     flutterRateSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
     flutterDepthSlider.setName("Flutter Depth");
     flutterDepthSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    wowRateSlider.setName("Wow Rate");
+    wowRateSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    wowDepthSlider.setName("Wow Depth");
+    wowDepthSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    scrapeFlutterSlider.setName("Scrape Flutter");
+    scrapeFlutterSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
     
     for (auto i = 0; i < getNumChildComponents(); i++)
     {
@@ -64,6 +79,29 @@ TapepmAudioProcessorEditor::TapepmAudioProcessorEditor (TapepmAudioProcessor& p)
         }
     }
     
+    addAndMakeVisible(qualityBox);
+    qualityBox.addItemList({ "Draft (RK2)", "Standard (RK4)", "Newton-Raphson", "Eco (table)" }, 1);
+    qualityLabel.setText("Quality", juce::dontSendNotification);
+    qualityLabel.attachToComponent(&qualityBox, true);
+    addAndMakeVisible(qualityLabel);
+    addAndMakeVisible(oversamplingBox);
+    oversamplingBox.addItemList({ "Auto", "1x", "2x", "4x", "8x", "16x" }, 1);
+    oversamplingLabel.setText("Oversampling", juce::dontSendNotification);
+    oversamplingLabel.attachToComponent(&oversamplingBox, true);
+    addAndMakeVisible(oversamplingLabel);
+    addAndMakeVisible(oversamplingFilterBox);
+    oversamplingFilterBox.addItemList({ "Linear phase FIR", "Polyphase IIR" }, 1);
+    oversamplingFilterLabel.setText("Oversampling filter", juce::dontSendNotification);
+    oversamplingFilterLabel.attachToComponent(&oversamplingFilterBox, true);
+    addAndMakeVisible(oversamplingFilterLabel);
+    addAndMakeVisible(flutterInterpolationBox);
+    flutterInterpolationBox.addItemList({ "Cubic", "Allpass" }, 1);
+    flutterInterpolationLabel.setText("Flutter interpolation", juce::dontSendNotification);
+    flutterInterpolationLabel.attachToComponent(&flutterInterpolationBox, true);
+    addAndMakeVisible(flutterInterpolationLabel);
+    addAndMakeVisible(offlineHighQualityButton);
+    addAndMakeVisible(trackingButton);
+
     for (auto* child : getChildren())
     {
         
@@ -80,6 +118,15 @@ TapepmAudioProcessorEditor::TapepmAudioProcessorEditor (TapepmAudioProcessor& p)
     driveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "DRIVE", driveSlider);
     flutterRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "FLUTTER_RATE", flutterRateSlider);
     flutterDepthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "FLUTTER_DEPTH", flutterDepthSlider);
+    wowRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "WOW_RATE", wowRateSlider);
+    wowDepthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "WOW_DEPTH", wowDepthSlider);
+    scrapeFlutterAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, "SCRAPE_FLUTTER", scrapeFlutterSlider);
+    qualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, "QUALITY", qualityBox);
+    oversamplingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, "OVERSAMPLING", oversamplingBox);
+    oversamplingFilterAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, "OVERSAMPLING_FILTER", oversamplingFilterBox);
+    flutterInterpolationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, "FLUTTER_INTERPOLATION", flutterInterpolationBox);
+    offlineHighQualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(apvts, "OFFLINE_HQ", offlineHighQualityButton);
+    trackingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(apvts, "TRACKING", trackingButton);
     
 }
 
@@ -93,11 +140,73 @@ void TapepmAudioProcessorEditor::paint (juce::Graphics& g)
 {
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
     g.setColour(juce::Colours::white);
+#if TAPEPM_PROFILER
+    paintStageLoads(g);
+#endif
+}
+
+#if TAPEPM_PROFILER
+void TapepmAudioProcessorEditor::timerCallback()
+{
+    std::array<float, StageProfiler::numStages + 1> sum {}, peak {};
+    int numFrames = 0;
+    // Drains the FIFO, it holds more than a timer period of blocks
+    while (int numRead = audioProcessor.getProfiler().readFrames(profilerFrames.data(), (int) profilerFrames.size()))
+    {
+        for (int i = 0; i < numRead; i++)
+        {
+            float total = 0;
+            for (int stage = 0; stage <= StageProfiler::numStages; stage++)
+            {
+                const float load = stage < StageProfiler::numStages ? profilerFrames[i].load[stage] : total;
+                total += load;
+                sum[stage] += load;
+                peak[stage] = juce::jmax(peak[stage], load);
+            }
+        }
+        numFrames += numRead;
+    }
+    if (numFrames == 0)
+        return;
+    for (int stage = 0; stage <= StageProfiler::numStages; stage++)
+    {
+        stageLoad[stage] = sum[stage] / numFrames;
+        stagePeak[stage] = juce::jmax(peak[stage], stagePeak[stage] * 0.9f);
+    }
+    repaint(profilerArea);
+}
+
+void TapepmAudioProcessorEditor::paintStageLoads(juce::Graphics& g)
+{
+    auto area = profilerArea.reduced(10, 5);
+    g.setFont((float) profilerRowHeight - 4.f);
+    auto drawRow = [&] (const juce::String& name, float load, float peak)
+    {
+        auto row = area.removeFromTop(profilerRowHeight);
+        g.setColour(juce::Colours::white);
+        g.drawText(name, row.removeFromLeft(110), juce::Justification::centredLeft);
+        g.drawText(juce::String(load * 100.f, 1) + " %", row.removeFromRight(50), juce::Justification::centredRight);
+        // Full width is the whole budget of a block
+        auto bar = row.reduced(4, 3).toFloat();
+        g.setColour(juce::Colours::white.withAlpha(0.2f));
+        g.fillRect(bar);
+        g.setColour(peak > 1.f ? juce::Colours::red : juce::Colours::orange);
+        g.fillRect(bar.withWidth(bar.getWidth() * juce::jmin(1.f, load)));
+        g.fillRect(bar.withX(bar.getX() + bar.getWidth() * juce::jmin(1.f, peak)).withWidth(1.f));
+    };
+    for (int stage = 0; stage < StageProfiler::numStages; stage++)
+        drawRow(StageProfiler::getStageName(stage), stageLoad[stage], stagePeak[stage]);
+    drawRow("Total", stageLoad[StageProfiler::numStages], stagePeak[StageProfiler::numStages]);
 }
+#endif
 
 void TapepmAudioProcessorEditor::resized()
 {
-    auto area = getLocalBounds();
+    auto bounds = getLocalBounds();
+#if TAPEPM_PROFILER
+    profilerArea = bounds.removeFromBottom(profilerHeight);
+#endif
+    auto area = bounds;
     auto labelArea = area.removeFromLeft(150);
     for (int i = 0; i < sliderLabels.size(); i++)
     {
@@ -115,5 +224,14 @@ void TapepmAudioProcessorEditor::resized()
     driveSlider.setBounds(area.removeFromTop(50));
     flutterRateSlider.setBounds(area.removeFromTop(50));
     flutterDepthSlider.setBounds(area.removeFromTop(50));
+    wowRateSlider.setBounds(area.removeFromTop(50));
+    wowDepthSlider.setBounds(area.removeFromTop(50));
+    scrapeFlutterSlider.setBounds(area.removeFromTop(50));
     outputGainSlider.setBounds(area.removeFromTop(50));
+    qualityBox.setBounds(area.removeFromTop(50).reduced(10));
+    oversamplingBox.setBounds(area.removeFromTop(50).reduced(10));
+    oversamplingFilterBox.setBounds(area.removeFromTop(50).reduced(10));
+    flutterInterpolationBox.setBounds(area.removeFromTop(50).reduced(10));
+    offlineHighQualityButton.setBounds(bounds.removeFromBottom(50).reduced(10));
+    trackingButton.setBounds(bounds.removeFromBottom(50).reduced(10));
 }
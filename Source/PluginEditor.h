@@ -15,6 +15,9 @@
 /**
 */
 class TapepmAudioProcessorEditor  : public juce::AudioProcessorEditor
+#if TAPEPM_PROFILER
+                                   , private juce::Timer
+#endif
 {
 public:
     TapepmAudioProcessorEditor (TapepmAudioProcessor&);
@@ -25,6 +28,18 @@ public:
     void resized() override;
 
 private:
+#if TAPEPM_PROFILER
+    void timerCallback() override;
+    void paintStageLoads(juce::Graphics& g);
+    static constexpr int profilerRowHeight = 16;
+    static constexpr int profilerHeight = (StageProfiler::numStages + 1) * profilerRowHeight + 10;
+    juce::Rectangle<int> profilerArea;
+    std::vector<StageProfiler::Frame> profilerFrames;
+    // Mean load over the last timer period and a slowly falling peak, per stage and the total last
+    std::array<float, StageProfiler::numStages + 1> stageLoad {};
+    std::array<float, StageProfiler::numStages + 1> stagePeak {};
+#endif
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     TapepmAudioProcessor& audioProcessor;
@@ -39,6 +54,19 @@ private:
     juce::Slider driveSlider;
     juce::Slider flutterRateSlider;
     juce::Slider flutterDepthSlider;
+    juce::Slider wowRateSlider;
+    juce::Slider wowDepthSlider;
+    juce::Slider scrapeFlutterSlider;
+    juce::ComboBox qualityBox;
+    juce::Label qualityLabel;
+    juce::ComboBox oversamplingBox;
+    juce::Label oversamplingLabel;
+    juce::ComboBox oversamplingFilterBox;
+    juce::Label oversamplingFilterLabel;
+    juce::ComboBox flutterInterpolationBox;
+    juce::Label flutterInterpolationLabel;
+    juce::ToggleButton offlineHighQualityButton { "High quality offline render" };
+    juce::ToggleButton trackingButton { "Tracking (zero latency)" };
 
     std::vector<std::unique_ptr<juce::Label>> sliderLabels;
     
@@ -52,6 +80,15 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> driveAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> flutterRateAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> flutterDepthAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> wowRateAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> wowDepthAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> scrapeFlutterAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> qualityAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingFilterAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> flutterInterpolationAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> offlineHighQualityAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> trackingAttachment;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TapepmAudioProcessorEditor)
 };
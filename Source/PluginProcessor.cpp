@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include <optional>
 
 //==============================================================================
 TapepmAudioProcessor::TapepmAudioProcessor()
@@ -22,10 +23,30 @@ TapepmAudioProcessor::TapepmAudioProcessor()
                        ), apvts(*this, nullptr, "PARAMETERS", createParameters())
 #endif
 {
+    headGapParam = apvts.getRawParameterValue("HEAD_GAP");
+    headSpacingParam = apvts.getRawParameterValue("HEAD_TAPE_SPACING");
+    tapeThicknessParam = apvts.getRawParameterValue("TAPE_THICKNESS");
+    tapeSpeedParam = apvts.getRawParameterValue("TAPE_SPEED");
+    inputGainParam = apvts.getRawParameterValue("INPUT_GAIN");
+    outputGainParam = apvts.getRawParameterValue("OUTPUT_GAIN");
+    driveParam = apvts.getRawParameterValue("DRIVE");
+    flutterRateParam = apvts.getRawParameterValue("FLUTTER_RATE");
+    flutterDepthParam = apvts.getRawParameterValue("FLUTTER_DEPTH");
+    wowRateParam = apvts.getRawParameterValue("WOW_RATE");
+    wowDepthParam = apvts.getRawParameterValue("WOW_DEPTH");
+    scrapeFlutterParam = apvts.getRawParameterValue("SCRAPE_FLUTTER");
+    flutterInterpolationParam = apvts.getRawParameterValue("FLUTTER_INTERPOLATION");
+    qualityParam = apvts.getRawParameterValue("QUALITY");
+    oversamplingParam = apvts.getRawParameterValue("OVERSAMPLING");
+    oversamplingFilterParam = apvts.getRawParameterValue("OVERSAMPLING_FILTER");
+    offlineHighQualityParam = apvts.getRawParameterValue("OFFLINE_HQ");
+    trackingParam = apvts.getRawParameterValue("TRACKING");
+    biasGainParam = apvts.getRawParameterValue("BIAS_GAIN");
 }
 
 TapepmAudioProcessor::~TapepmAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -63,7 +84,7 @@ bool TapepmAudioProcessor::isMidiEffect() const
 
 double TapepmAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds;
 }
 
 int TapepmAudioProcessor::getNumPrograms()
@@ -93,8 +114,38 @@ void TapepmAudioProcessor::changeProgramName (int index, const juce::String& new
 //==============================================================================
 void TapepmAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    tapeMachine.prepareToPlay(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
-    startTimerHz(10);
+    // Hosts set the precision before they prepare
+    if (isUsingDoublePrecision())
+    {
+        updateParameters(doubleMachine);
+        updateRenderMode(doubleMachine);
+        doubleMachine.prepareToPlay(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
+        updateLatencyAndTail(doubleMachine);
+    }
+    else
+    {
+        updateParameters(floatMachine);
+        updateRenderMode(floatMachine);
+        floatMachine.prepareToPlay(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
+        updateLatencyAndTail(floatMachine);
+    }
+    setLatencySamples(machineLatency);
+}
+
+template <typename SampleType>
+void TapepmAudioProcessor::updateLatencyAndTail (TapeMachine<SampleType>& machine)
+{
+    machineLatency = machine.getLatencyInSamples();
+    // Once the input stops, the output rings on until the machine has forgotten it
+    tailLengthSeconds = machine.getSettlingTimeInSamples() / getSampleRate();
+}
+
+void TapepmAudioProcessor::handleAsyncUpdate()
+{
+    // setLatencySamples notifies the host under a lock, so it's kept off the audio thread
+    const int latency = machineLatency;
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
 }
 
 void TapepmAudioProcessor::releaseResources()
@@ -110,12 +161,9 @@ bool TapepmAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) c
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel runs through its own tape track, so any layout works
+    // as long as there is at least one channel.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -129,19 +177,52 @@ bool TapepmAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) c
 }
 #endif
 
+bool TapepmAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void TapepmAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process(buffer, floatMachine);
+}
+
+void TapepmAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process(buffer, doubleMachine);
+}
+
+template <typename SampleType>
+void TapepmAudioProcessor::process (juce::AudioBuffer<SampleType>& buffer, TapeMachine<SampleType>& machine)
 {
     juce::ScopedNoDenormals noDenormals;
+    // Offline blocks may design the loss filter in place, see TapeMachine::setNonRealtime
+    std::optional<RealtimeCheck::ScopedRealtimeSection> realtimeSection;
+    if (! isNonRealtime())
+        realtimeSection.emplace("TapepmAudioProcessor::processBlock");
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
-    juce::dsp::AudioBlock<float> block(buffer);
-    
-    tapeMachine.processBlock(block);
+    juce::dsp::AudioBlock<SampleType> block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, totalNumOutputChannels);
+    updateParameters(machine);
+    updateRenderMode(machine);
     
+    machine.processBlock(block);
+    // Oversampling, loss filter order and flutter can all change the latency
+    const int previousLatency = machineLatency;
+    updateLatencyAndTail(machine);
+    if (machineLatency == previousLatency)
+        return;
+    // Without a deadline blocking here costs nothing. Live, the message thread tells the host;
+    // posting the message may lock, which is fine on the rare blocks the latency changes.
+    realtimeSection.reset();
+    if (isNonRealtime())
+        setLatencySamples(machineLatency);
+    else
+        triggerAsyncUpdate();
 }
 
 //==============================================================================
@@ -176,42 +257,40 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
     return new TapepmAudioProcessor();
 }
 
-void TapepmAudioProcessor::timerCallback()
-{
-    auto headGapPar = apvts.getRawParameterValue("HEAD_GAP");
-    float headGap = headGapPar->load();
-    auto headSpacingPar = apvts.getRawParameterValue("HEAD_TAPE_SPACING");
-    float headSpacing = headSpacingPar->load();
-    auto tapeThicknessPar = apvts.getRawParameterValue("TAPE_THICKNESS");
-    float tapeThickness = tapeThicknessPar->load();
-    auto tapeSpeedPar = apvts.getRawParameterValue("TAPE_SPEED");
-    float tapeSpeed = tapeSpeedPar->load();
-    auto inputGainPar = apvts.getRawParameterValue("INPUT_GAIN");
-    float inputGain = inputGainPar->load();
-    auto outputGainPar = apvts.getRawParameterValue("OUTPUT_GAIN");
-    float outputGain = outputGainPar->load();
-    auto drivePar = apvts.getRawParameterValue("DRIVE");
-    float drive = drivePar->load();
-    
-    auto flutterRatePar = apvts.getRawParameterValue("FLUTTER_RATE");
-    float flutterRate = flutterRatePar->load();
-    auto flutterDepthPar = apvts.getRawParameterValue("FLUTTER_DEPTH");
-    float flutterDepth = flutterDepthPar->load();
-    
-    UserParameters& params = tapeMachine.getUserParams();
-    params.drive = drive;
-    params.gapWidth = headGap;
-    params.spacingTapeHead = headSpacing;
-    params.tapeSpeed = tapeSpeed;
-    params.tapeThickness = tapeThickness;
-    params.inputGain = inputGain;
-    params.flutterRate = flutterRate;
-    params.flutterDepth = flutterDepth;
-    params.outputGain = outputGain;
-    auto biasGainPar = apvts.getRawParameterValue("BIAS_GAIN");
-    float biasGain = biasGainPar->load();
-    BiasSignal& biasSignal = tapeMachine.getBiasSignal();
-    biasSignal.setGain(biasGain);
+template <typename SampleType>
+void TapepmAudioProcessor::updateRenderMode (TapeMachine<SampleType>& machine)
+{
+    // Hosts may switch to offline rendering without preparing again, every resource of
+    // the offline profile is already allocated so this is safe to do per block. The host compensates
+    // for the latency it had when the bounce started, so the profile leaves the latency as it is.
+    bool offlineHighQuality = offlineHighQualityParam->load() > 0.5f;
+    machine.setOfflineRender(isNonRealtime() && offlineHighQuality, true);
+    machine.setNonRealtime(isNonRealtime());
+}
+
+template <typename SampleType>
+void TapepmAudioProcessor::updateParameters (TapeMachine<SampleType>& machine)
+{
+    // The stages ramp gain, drive and flutter depth towards these values themselves
+    UserParameters& params = machine.getUserParams();
+    params.drive = driveParam->load();
+    params.gapWidth = headGapParam->load();
+    params.spacingTapeHead = headSpacingParam->load();
+    params.tapeSpeed = tapeSpeedParam->load();
+    params.tapeThickness = tapeThicknessParam->load();
+    params.inputGain = inputGainParam->load();
+    params.flutterRate = flutterRateParam->load();
+    params.flutterDepth = flutterDepthParam->load();
+    params.wowRate = wowRateParam->load();
+    params.wowDepth = wowDepthParam->load();
+    params.scrapeFlutter = scrapeFlutterParam->load();
+    params.flutterInterpolation = static_cast<DelayInterpolation>((int) flutterInterpolationParam->load());
+    params.outputGain = outputGainParam->load();
+    params.solver = static_cast<HysteresisSolver>((int) qualityParam->load());
+    params.oversampling = (int) oversamplingParam->load();
+    params.oversamplingFilter = static_cast<OversamplingFilter>((int) oversamplingFilterParam->load());
+    params.tracking = trackingParam->load() > 0.5f;
+    machine.getBiasSignal().setGain(biasGainParam->load());
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout TapepmAudioProcessor::createParameters()
@@ -228,6 +307,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout TapepmAudioProcessor::create
     headGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "TAPE_SPEED",  1 }, "Tape Speed", 5, 30, 15));
     headGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "OUTPUT_GAIN",  1 }, "Output Gain", 0.00, 2, 1.00f));
     headGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "DRIVE",  1 }, "Drive", 0.00f, 1.0f, 0.50f));
+    // Order matches HysteresisSolver
+    headGroup->addChild(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "QUALITY",  1 }, "Quality", juce::StringArray { "Draft (RK2)", "Standard (RK4)", "Newton-Raphson", "Eco (table)" }, 1));
     params.push_back(std::move(headGroup));
     
     auto biasGroup = std::make_unique<juce::AudioProcessorParameterGroup>("BIAS", "BIAS_GROUP", "|");
@@ -236,8 +317,21 @@ juce::AudioProcessorValueTreeState::ParameterLayout TapepmAudioProcessor::create
     
     auto flutterGroup = std::make_unique<juce::AudioProcessorParameterGroup>("FLUTTER", "FLUTTER_GROUP", "|");
     flutterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "FLUTTER_RATE",  1 }, "Flutter Rate", 0.0, 20.0, 0.f));
-    flutterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "FLUTTER_DEPTH",  1 }, "Flutter DEPTH", 0.0, 0.4, 0.f));
+    flutterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "FLUTTER_DEPTH",  1 }, "Flutter DEPTH", 0.0, UserParameters::maxFlutterDepth, 0.f));
+    flutterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "WOW_RATE",  1 }, "Wow Rate", 0.0, 4.0, 0.f));
+    flutterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "WOW_DEPTH",  1 }, "Wow Depth", 0.0, UserParameters::maxWowDepth, 0.f));
+    flutterGroup->addChild(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "SCRAPE_FLUTTER",  1 }, "Scrape Flutter", 0.0, UserParameters::maxScrapeFlutter, 0.f));
+    // Order matches DelayInterpolation
+    flutterGroup->addChild(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "FLUTTER_INTERPOLATION",  1 }, "Flutter interpolation", juce::StringArray { "Cubic", "Allpass" }, 0));
     params.push_back(std::move(flutterGroup));
     
+    auto oversamplingGroup = std::make_unique<juce::AudioProcessorParameterGroup>("OVERSAMPLING", "OVERSAMPLING_GROUP", "|");
+    // Order matches UserParameters::oversampling and OversamplingFilter
+    oversamplingGroup->addChild(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "OVERSAMPLING",  1 }, "Oversampling", juce::StringArray { "Auto", "1x", "2x", "4x", "8x", "16x" }, 5));
+    oversamplingGroup->addChild(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "OVERSAMPLING_FILTER",  1 }, "Oversampling Filter", juce::StringArray { "Linear phase FIR", "Polyphase IIR" }, 0));
+    oversamplingGroup->addChild(std::make_unique<juce::AudioParameterBool>(juce::ParameterID { "OFFLINE_HQ",  1 }, "High quality offline render", true));
+    oversamplingGroup->addChild(std::make_unique<juce::AudioParameterBool>(juce::ParameterID { "TRACKING",  1 }, "Tracking (zero latency)", false));
+    params.push_back(std::move(oversamplingGroup));
+    
     return { params.begin(), params.end() };
 }
@@ -11,6 +11,7 @@
 #include <JuceHeader.h>
 #include "TapeSim.h"
 #include "Parameters.h"
+#include "RealtimeCheck.h"
 
 //==============================================================================
 /**
@@ -19,7 +20,7 @@ class TapepmAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
-                            , public juce::Timer
+                             , private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -35,6 +36,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -60,13 +63,50 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     juce::AudioProcessorValueTreeState& getApvts() { return apvts; };
-    void timerCallback() override;
+    StageProfiler& getProfiler() { return isUsingDoublePrecision() ? doubleMachine.getProfiler() : floatMachine.getProfiler(); };
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TapepmAudioProcessor)
     
     juce::AudioProcessorValueTreeState apvts;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& buffer, TapeMachine<SampleType>& machine);
+    template <typename SampleType>
+    void updateRenderMode (TapeMachine<SampleType>& machine);
+    // Copies the parameter values into the tape machine, called on the audio thread once per block
+    template <typename SampleType>
+    void updateParameters (TapeMachine<SampleType>& machine);
+    // Passes latency changes the audio thread has seen on to the host
+    void handleAsyncUpdate() override;
+    template <typename SampleType>
+    void updateLatencyAndTail (TapeMachine<SampleType>& machine);
     
-    TapeMachine tapeMachine;
+    // Looked up once, so the audio thread only does atomic loads
+    std::atomic<float>* headGapParam = nullptr;
+    std::atomic<float>* headSpacingParam = nullptr;
+    std::atomic<float>* tapeThicknessParam = nullptr;
+    std::atomic<float>* tapeSpeedParam = nullptr;
+    std::atomic<float>* inputGainParam = nullptr;
+    std::atomic<float>* outputGainParam = nullptr;
+    std::atomic<float>* driveParam = nullptr;
+    std::atomic<float>* flutterRateParam = nullptr;
+    std::atomic<float>* flutterDepthParam = nullptr;
+    std::atomic<float>* wowRateParam = nullptr;
+    std::atomic<float>* wowDepthParam = nullptr;
+    std::atomic<float>* scrapeFlutterParam = nullptr;
+    std::atomic<float>* flutterInterpolationParam = nullptr;
+    std::atomic<float>* qualityParam = nullptr;
+    std::atomic<float>* oversamplingParam = nullptr;
+    std::atomic<float>* oversamplingFilterParam = nullptr;
+    std::atomic<float>* offlineHighQualityParam = nullptr;
+    std::atomic<float>* trackingParam = nullptr;
+    std::atomic<float>* biasGainParam = nullptr;
+
+    // Only the machine for the host's processing precision is prepared and run
+    TapeMachine<float> floatMachine;
+    TapeMachine<double> doubleMachine;
+    // Written by the audio thread after every block, which triggers an update when the latency changes
+    std::atomic<int> machineLatency { 0 };
+    std::atomic<double> tailLengthSeconds { 0 };
 };
@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 17 Oct 2026 8:05:13pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+
+#if TAPEPM_RT_CHECK
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Nesting depth of sections on this thread
+    thread_local int realtimeDepth = 0;
+    // Set while reporting, the assertion and the log allocate themselves
+    thread_local bool reporting = false;
+    // Counted per thread, so other threads allocating at the same time don't show up in a section
+    thread_local int threadCounts[RealtimeCheck::numViolationTypes] = {};
+    std::atomic<int> totalCounts[RealtimeCheck::numViolationTypes] = {};
+
+    const char* getViolationName(int violation)
+    {
+        switch (violation)
+        {
+            case RealtimeCheck::allocation: return "allocations";
+            case RealtimeCheck::deallocation: return "frees";
+            case RealtimeCheck::lock: return "locks";
+            default: return "";
+        }
+    }
+}
+
+RealtimeCheck::ScopedRealtimeSection::ScopedRealtimeSection(const char* name) : name(name)
+{
+    for (int i = 0; i < numViolationTypes; i++)
+        countsAtStart[i] = threadCounts[i];
+    realtimeDepth++;
+}
+
+RealtimeCheck::ScopedRealtimeSection::~ScopedRealtimeSection()
+{
+    realtimeDepth--;
+    if (realtimeDepth > 0)
+        return;
+    bool violated = false;
+    for (int i = 0; i < numViolationTypes; i++)
+        violated |= threadCounts[i] != countsAtStart[i];
+    if (! violated)
+        return;
+    // fprintf to stderr doesn't allocate, and the section has ended anyway
+    std::fprintf(stderr, "Real-time violation in %s:", name);
+    for (int i = 0; i < numViolationTypes; i++)
+        std::fprintf(stderr, " %d %s", threadCounts[i] - countsAtStart[i], getViolationName(i));
+    std::fprintf(stderr, "\n");
+}
+
+void RealtimeCheck::notify(Violation violation)
+{
+    if (realtimeDepth == 0 || reporting)
+        return;
+    reporting = true;
+    const bool isFirst = threadCounts[violation]++ == 0;
+    totalCounts[violation]++;
+    // Only the first one asserts, otherwise a debugger stops on every block
+    if (isFirst)
+        jassertfalse;
+    reporting = false;
+}
+
+int RealtimeCheck::getNumViolations(Violation violation)
+{
+    return totalCounts[violation];
+}
+
+#if defined (__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+// malloc catches operator new, std::vector, juce::HeapBlock and anything else in the process
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        RealtimeCheck::notify(RealtimeCheck::allocation);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        RealtimeCheck::notify(RealtimeCheck::allocation);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size)
+    {
+        RealtimeCheck::notify(RealtimeCheck::allocation);
+        return __libc_realloc(pointer, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        RealtimeCheck::notify(RealtimeCheck::allocation);
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        return memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, size_t alignment, size_t size)
+    {
+        *pointer = memalign(alignment, size);
+        return *pointer == nullptr ? ENOMEM : 0;
+    }
+
+    void free(void* pointer)
+    {
+        if (pointer != nullptr)
+            RealtimeCheck::notify(RealtimeCheck::deallocation);
+        __libc_free(pointer);
+    }
+
+    // std::mutex and juce::CriticalSection both end up here, try locks don't block and aren't counted
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        using LockFunction = int (*)(pthread_mutex_t*);
+        // Constant initialised, so there is no guard that would lock a mutex itself. Looking it up twice is harmless.
+        static std::atomic<LockFunction> libraryLock { nullptr };
+        auto next = libraryLock.load(std::memory_order_relaxed);
+        if (next == nullptr)
+        {
+            next = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            libraryLock.store(next, std::memory_order_relaxed);
+        }
+        RealtimeCheck::notify(RealtimeCheck::lock);
+        return next(mutex);
+    }
+}
+
+#else
+
+void* operator new(std::size_t size)
+{
+    RealtimeCheck::notify(RealtimeCheck::allocation);
+    if (auto* pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        RealtimeCheck::notify(RealtimeCheck::deallocation);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Created: 17 Oct 2026 8:05:13pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Build with TAPEPM_RT_CHECK=1 to catch allocations and locks on the audio thread
+#ifndef TAPEPM_RT_CHECK
+ #define TAPEPM_RT_CHECK 0
+#endif
+
+/** Debug check for code that must not allocate or lock.
+
+    While a ScopedRealtimeSection is alive on a thread, every allocation, free and
+    mutex lock on that thread counts as a violation. The first violation of a section
+    hits a jassert at the offending call, so a debugger stops with the culprit on the
+    stack, and the section prints a summary to stderr when it ends.
+
+    Allocations are caught by replacing operator new and delete, on glibc also malloc
+    and friends, locks only on glibc through pthread_mutex_lock. Replacements only take
+    effect in the executable they're linked into, so use the Standalone build: a
+    plugin loaded on Linux may see the host's allocator instead.
+
+    Without TAPEPM_RT_CHECK none of this is compiled and the section is empty.
+*/
+class RealtimeCheck
+{
+public:
+    enum Violation
+    {
+        allocation,
+        deallocation,
+        lock,
+        numViolationTypes
+    };
+
+    class ScopedRealtimeSection
+    {
+    public:
+#if TAPEPM_RT_CHECK
+        explicit ScopedRealtimeSection(const char* name);
+        ~ScopedRealtimeSection();
+    private:
+        const char* name;
+        int countsAtStart[numViolationTypes];
+#else
+        explicit ScopedRealtimeSection(const char*) {}
+#endif
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+    };
+
+#if TAPEPM_RT_CHECK
+    // Called by the hooks, does nothing outside a section
+    static void notify(Violation violation);
+    // Total violations since the start of the program
+    static int getNumViolations(Violation violation);
+#endif
+};
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    SIMDLanes.h
+    Created: 17 Oct 2026 11:02:47am
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** A fixed number of values processed in lock step, one per channel.
+
+    Every operation is a plain loop over the lanes which compilers turn into
+    SIMD instructions. Unlike juce::dsp::SIMDRegister it supports division,
+    which the hysteresis model needs. Conditions are expressed as masks of
+    0 and 1 so the kernels stay free of branches, see the simd namespace. Scalars take the lanes' type,
+    so a double literal works with float lanes without pulling in double maths.
+*/
+template <typename T, size_t N>
+struct SIMDLanes
+{
+    using value_type = T;
+    static constexpr size_t size = N;
+
+    alignas (sizeof (T) * N) T v[N];
+
+    SIMDLanes() = default;
+    SIMDLanes (T value) { for (size_t i = 0; i < N; i++) v[i] = value; }
+
+    T& operator[] (size_t i) { return v[i]; }
+    T operator[] (size_t i) const { return v[i]; }
+};
+
+#define SIMD_LANES_BINARY_OP(op) \
+    template <typename T, size_t N> \
+    inline SIMDLanes<T, N> operator op (const SIMDLanes<T, N>& a, const SIMDLanes<T, N>& b) \
+    { SIMDLanes<T, N> r; for (size_t i = 0; i < N; i++) r.v[i] = a.v[i] op b.v[i]; return r; } \
+    template <typename T, size_t N> \
+    inline SIMDLanes<T, N> operator op (const SIMDLanes<T, N>& a, typename SIMDLanes<T, N>::value_type b) \
+    { SIMDLanes<T, N> r; for (size_t i = 0; i < N; i++) r.v[i] = a.v[i] op b; return r; } \
+    template <typename T, size_t N> \
+    inline SIMDLanes<T, N> operator op (typename SIMDLanes<T, N>::value_type a, const SIMDLanes<T, N>& b) \
+    { SIMDLanes<T, N> r; for (size_t i = 0; i < N; i++) r.v[i] = a op b.v[i]; return r; }
+
+SIMD_LANES_BINARY_OP(+)
+SIMD_LANES_BINARY_OP(-)
+SIMD_LANES_BINARY_OP(*)
+SIMD_LANES_BINARY_OP(/)
+
+#undef SIMD_LANES_BINARY_OP
+
+/** Lane wise comparisons and functions. They live in their own namespace, since
+    unqualified names like tanh or select would clash with std and juce overloads.
+*/
+namespace simd
+{
+    /** 1 where a >= b, 0 otherwise */
+    template <typename T, size_t N>
+    inline SIMDLanes<T, N> greaterThanOrEqual (const SIMDLanes<T, N>& a, typename SIMDLanes<T, N>::value_type b)
+    {
+        SIMDLanes<T, N> r;
+        for (size_t i = 0; i < N; i++) r.v[i] = (T) (a.v[i] >= b);
+        return r;
+    }
+
+    /** 1 where a and b have the same sign, 0 otherwise */
+    template <typename T, size_t N>
+    inline SIMDLanes<T, N> sameSign (const SIMDLanes<T, N>& a, const SIMDLanes<T, N>& b)
+    {
+        SIMDLanes<T, N> r;
+        for (size_t i = 0; i < N; i++) r.v[i] = (T) ((a.v[i] >= 0) == (b.v[i] >= 0));
+        return r;
+    }
+
+    /** 1 where |a| <= b, 0 otherwise */
+    template <typename T, size_t N>
+    inline SIMDLanes<T, N> absLessThanOrEqual (const SIMDLanes<T, N>& a, typename SIMDLanes<T, N>::value_type b)
+    {
+        SIMDLanes<T, N> r;
+        for (size_t i = 0; i < N; i++) r.v[i] = (T) (std::abs (a.v[i]) <= b);
+        return r;
+    }
+
+    /** 1 where a == b, 0 otherwise */
+    template <typename T, size_t N>
+    inline SIMDLanes<T, N> equal (const SIMDLanes<T, N>& a, typename SIMDLanes<T, N>::value_type b)
+    {
+        SIMDLanes<T, N> r;
+        for (size_t i = 0; i < N; i++) r.v[i] = (T) (a.v[i] == b);
+        return r;
+    }
+
+    /** 1 where a is not a number, 0 otherwise */
+    template <typename T, size_t N>
+    inline SIMDLanes<T, N> isNan (const SIMDLanes<T, N>& a)
+    {
+        SIMDLanes<T, N> r;
+        for (size_t i = 0; i < N; i++) r.v[i] = (T) (a.v[i] != a.v[i]);
+        return r;
+    }
+
+    /** Picks ifTrue where the mask is non zero and ifFalse elsewhere */
+    template <typename T, size_t N>
+    inline SIMDLanes<T, N> select (const SIMDLanes<T, N>& mask, const SIMDLanes<T, N>& ifTrue, const SIMDLanes<T, N>& ifFalse)
+    {
+        SIMDLanes<T, N> r;
+        for (size_t i = 0; i < N; i++) r.v[i] = mask.v[i] != 0 ? ifTrue.v[i] : ifFalse.v[i];
+        return r;
+    }
+
+    template <typename T, size_t N>
+    inline SIMDLanes<T, N> tanh (const SIMDLanes<T, N>& a)
+    {
+        SIMDLanes<T, N> r;
+        for (size_t i = 0; i < N; i++) r.v[i] = std::tanh (a.v[i]);
+        return r;
+    }
+}
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    StageProfiler.h
+    Created: 17 Oct 2026 8:41:27pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set to 0 to strip the profiler out, every call then compiles to nothing. Release builds leave it
+// out unless they set it to 1, as the Profile configuration does.
+#ifndef TAPEPM_PROFILER
+ #if JUCE_DEBUG
+  #define TAPEPM_PROFILER 1
+ #else
+  #define TAPEPM_PROFILER 0
+ #endif
+#endif
+
+/** Times the stages of the tape machine on the audio thread.
+
+    Every block takes one timestamp per stage and pushes the time each stage
+    took, as a fraction of the block's real-time budget, into a lock-free FIFO.
+    A stage may end several times in one block, e.g. once per sub-block, its
+    times are added up.
+    Another thread reads the frames out, e.g. the editor to show which stage
+    eats the budget. There must only be one reader at a time.
+
+    When the FIFO is full because nobody reads, frames are dropped.
+*/
+class StageProfiler
+{
+public:
+    // In processing order. Stages that share a pass are timed together.
+    enum Stage
+    {
+        upsample,
+        bias,
+        recordHead,
+        hysteresis, // Including the record head low pass
+        downsample,
+        playHead, // Including the high pass
+        lossFilter,
+        flutter,
+        numStages
+    };
+
+    struct Frame
+    {
+        // Time spent in each stage, 1 is the whole duration of the block
+        float load[numStages];
+    };
+
+    static const char* getStageName(int stage)
+    {
+        static const char* const names[numStages] = { "Upsample", "Bias", "Record head", "Hysteresis + LPF",
+                                                      "Downsample", "Play head + HPF", "Loss filter", "Flutter" };
+        return juce::isPositiveAndBelow(stage, (int) numStages) ? names[stage] : "";
+    }
+
+#if TAPEPM_PROFILER
+    void prepare(double sampleRate)
+    {
+        ticksPerSample = (double) juce::Time::getHighResolutionTicksPerSecond() / sampleRate;
+    }
+
+    void beginBlock(int numSamples)
+    {
+        inverseBudget = numSamples > 0 ? (float) (1.0 / (ticksPerSample * numSamples)) : 0.f;
+        current = {};
+        lastTimestamp = juce::Time::getHighResolutionTicks();
+    }
+
+    void endStage(Stage stage)
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        current.load[stage] += (float) (now - lastTimestamp) * inverseBudget;
+        lastTimestamp = now;
+    }
+
+    void endBlock()
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 > 0)
+            frames[(size_t) scope.startIndex1] = current;
+    }
+
+    // Copies out up to maxFrames of the oldest frames and returns how many there were
+    int readFrames(Frame* destination, int maxFrames)
+    {
+        const auto scope = fifo.read(juce::jmin(maxFrames, fifo.getNumReady()));
+        for (int i = 0; i < scope.blockSize1; i++)
+            destination[i] = frames[(size_t) (scope.startIndex1 + i)];
+        for (int i = 0; i < scope.blockSize2; i++)
+            destination[scope.blockSize1 + i] = frames[(size_t) (scope.startIndex2 + i)];
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+private:
+    // A few seconds of blocks at any reasonable block size and a 30 Hz reader
+    static constexpr int fifoSize = 512;
+    juce::AbstractFifo fifo { fifoSize };
+    std::array<Frame, fifoSize> frames {};
+    Frame current {};
+    double ticksPerSample = 0;
+    float inverseBudget = 0;
+    juce::int64 lastTimestamp = 0;
+#else
+    void prepare(double) {}
+    void beginBlock(int) {}
+    void endStage(Stage) {}
+    void endBlock() {}
+    int readFrames(Frame*, int) { return 0; }
+#endif
+};
@@ -12,227 +12,802 @@
 #include "Maths.h"
 
 
-TapeMachine::TapeMachine() : recHead(userParams), hysteresis(userParams), lossEffects(userParams), playHead(userParams), hpf(juce::dsp::IIR::Coefficients<float>::makeHighPass(44100, 35.f)), flutter(userParams) { }
+template <typename SampleType>
+TapeMachine<SampleType>::TapeMachine() : recHead(userParams), hysteresis(userParams), lossEffects(userParams), playHead(userParams), hpfCoefficients(Coefficients::makeHighPass(44100, 35)), lpfState(Coefficients::makeLowPass(44100 * 16, 24000, 1)), flutter(userParams) { }
 
-void TapeMachine::prepareToPlay (double sampleRate, int totalNumOutputChannels, int samplesPerBlock)
+template <typename SampleType>
+void TapeMachine<SampleType>::prepareToPlay (double sampleRate, int totalNumOutputChannels, int samplesPerBlock)
 {
-    oversampling = std::make_unique<juce::dsp::Oversampling<float>>(totalNumOutputChannels,
-                                                                    4,
-                                                                    juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple,
-                                                                    false);
-    oversampling->reset();
-    int oversampleFactor = 1 << 4;
-    oversampling->initProcessing(samplesPerBlock);
-    bias.prepareToPlay(sampleRate, oversampleFactor, samplesPerBlock);
-    hysteresis.prepareToPlay(sampleRate, oversampleFactor, samplesPerBlock);
-    lossEffects.prepareToPlay(sampleRate, samplesPerBlock);
-    flutter.prepareToPlay(sampleRate, samplesPerBlock);
+    this->sampleRate = sampleRate;
+    // Hosts that promise small blocks get small buffers, bigger blocks than promised are split all the same
+    subBlockSize = juce::jlimit(1, maxSubBlockSize, samplesPerBlock);
+    profiler.prepare(sampleRate);
+    for (int filter = 0; filter < numOversamplingFilters; filter++)
+    {
+        auto filterType = filter == (int) OversamplingFilter::IIR ? juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR
+                                                                  : juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple;
+        for (int order = 0; order <= maxOversamplingOrder; order++)
+        {
+            auto& os = oversamplers[filter * (maxOversamplingOrder + 1) + order];
+            os = std::make_unique<juce::dsp::Oversampling<SampleType>>(totalNumOutputChannels, order, filterType, false);
+            // Whole samples, so the latency reported to the host is exact. The IIR delay depends on
+            // the frequency anyway, padding it would only add latency to the tracking mode.
+            os->setUsingIntegerLatency(filter == (int) OversamplingFilter::FIR);
+            os->initProcessing(subBlockSize);
+            os->reset();
+        }
+    }
+    for (int order = 0; order <= maxOversamplingOrder; order++)
+    {
+        double rate = sampleRate * (1 << order);
+        lpfCoefficients[order] = Coefficients::makeLowPass(rate, (SampleType) juce::jmin(24000.0, rate * 0.45), 1);
+    }
+    int maxFactor = 1 << maxOversamplingOrder;
+    recHead.prepareToPlay(sampleRate, maxFactor, subBlockSize);
+    bias.prepareToPlay(sampleRate, maxFactor, subBlockSize);
+    hysteresis.prepareToPlay(sampleRate, maxFactor, totalNumOutputChannels, subBlockSize);
+    lossEffects.prepareToPlay(sampleRate, totalNumOutputChannels, subBlockSize);
+    playHead.prepareToPlay(sampleRate);
+    flutter.prepareToPlay(sampleRate, totalNumOutputChannels, subBlockSize);
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    auto filterCoefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 35.f);
-    hpf.reset();
-    hpf.prepare(spec);
-    *hpf.state = *filterCoefficients;
+    spec.maximumBlockSize = subBlockSize;
+    spec.numChannels = totalNumOutputChannels;
+    *hpfCoefficients = *Coefficients::makeHighPass(sampleRate, 35);
+    hpf.clear();
+    hpf.reserve(totalNumOutputChannels);
+    for (int ch = 0; ch < totalNumOutputChannels; ch++)
+        hpf.emplace_back(hpfCoefficients).prepare(spec);
     juce::dsp::ProcessSpec spec2;
-    spec2.maximumBlockSize = samplesPerBlock * oversampleFactor;
-    spec2.numChannels = 1;
-    spec2.sampleRate = sampleRate * oversampleFactor;
-    lpf.prepare(spec2);
-    lpf.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate * oversampleFactor, 24000, 1);
-}
-
-void TapeMachine::processBlock (juce::dsp::AudioBlock<float>& audioBuffer)
-{
-    juce::dsp::AudioBlock<float> oversampledBlock = oversampling->processSamplesUp(audioBuffer);
-    juce::dsp::AudioBlock<float> blockToEdit = oversampledBlock.getSingleChannelBlock(0);
-    bias.processBlock(blockToEdit);
-    recHead.processBlock(blockToEdit);
-    hysteresis.processBlock(blockToEdit);
-    juce::dsp::ProcessContextReplacing<float> oversampledContext(blockToEdit);
-    lpf.process(oversampledContext);
-    oversampling->processSamplesDown(audioBuffer);
-    juce::dsp::AudioBlock<float> normalBlock = audioBuffer.getSingleChannelBlock(0);
-    juce::dsp::ProcessContextReplacing<float> context(normalBlock);
-    hpf.process(context);
-    playHead.processBlock(normalBlock);
-    lossEffects.processBlock(normalBlock);
-    flutter.processBlock(normalBlock);
-    auto ch1 = audioBuffer.getChannelPointer(0); // TODO Fix stereo behavior
-    auto ch2 = audioBuffer.getChannelPointer(1);
-    std::copy(ch1, ch1 + audioBuffer.getNumSamples(), ch2);
+    spec2.maximumBlockSize = subBlockSize * maxFactor;
+    spec2.numChannels = totalNumOutputChannels;
+    spec2.sampleRate = sampleRate * maxFactor;
+    *lpfState = *lpfCoefficients[maxOversamplingOrder];
+    lpf.clear();
+    lpf.reserve(totalNumOutputChannels);
+    for (int ch = 0; ch < totalNumOutputChannels; ch++)
+        lpf.emplace_back(lpfState).prepare(spec2);
+    warmUpBuffer.setSize(totalNumOutputChannels, subBlockSize);
+    silentSamples = 0;
+    idle = false;
+    timelinePosition = 0;
+    oversampling = nullptr;
+    if (offlineRender)
+        applyOfflineProfile();
+    // Switching the factor resets the oversampling filters and changes the latency, so Auto
+    // decides here and keeps its factor until the host prepares again
+    autoOversamplingOrder = chooseOversamplingOrder();
+    biasOversamplingOrder = getLowestOrderFor(2.0 * (bias.getFrequency() + juce::jmin(20000.0, sampleRate * 0.5)));
+    setOversampling(getOversamplingOrder(), getOversamplingFilter());
+}
+
+template <typename SampleType>
+void TapeMachine<SampleType>::setOversampling(int order, OversamplingFilter filter)
+{
+    order = juce::jlimit(0, maxOversamplingOrder, order);
+    auto* next = oversamplers[(int) filter * (maxOversamplingOrder + 1) + order].get();
+    if (next == oversampling)
+        return;
+    oversampling = next;
+    oversampling->reset();
+    oversamplingOrder = order;
+    oversamplingFilter = filter;
+    recHead.setOversampling(1 << order);
+    bias.setOversampling(1 << order);
+    hysteresis.setOversampling(1 << order);
+    // Copy the values rather than the coefficient object, which would allocate on the audio thread
+    auto& source = lpfCoefficients[order]->coefficients;
+    auto& target = lpfState->coefficients;
+    jassert(source.size() == target.size());
+    std::copy(source.begin(), source.end(), target.begin());
+    for (auto& filter : lpf)
+        filter.reset();
+}
+
+template <typename SampleType>
+int TapeMachine<SampleType>::chooseOversamplingOrder() const
+{
+    // The hysteresis harmonics fall off roughly geometrically with the drive. Find the
+    // highest harmonic of the top of the audio band that is still above the threshold,
+    // then make sure it folds back above the audio band.
+    const double audioBand = juce::jmin(20000.0, sampleRate * 0.5);
+    const double drive = juce::jlimit(1.0e-3, 0.999, (double) userParams.drive);
+    const double harmonics = 1.0 + std::ceil(aliasingThresholdDb / (20.0 * std::log10(drive)));
+    return getLowestOrderFor((harmonics + 1.0) * audioBand);
+}
+
+template <typename SampleType>
+int TapeMachine<SampleType>::getLowestOrderFor(double requiredRate) const
+{
+    for (int order = 0; order < maxOversamplingOrder; order++)
+        if (sampleRate * (1 << order) >= requiredRate)
+            return order;
+    return maxOversamplingOrder;
+}
 
+template <typename SampleType>
+int TapeMachine<SampleType>::getOversamplingOrder() const
+{
+    int order = userParams.oversampling == 0 ? autoOversamplingOrder : userParams.oversampling - 1;
+    // The bias tone and its sidebands must fit below Nyquist, or they fold back into the audio band
+    if (bias.getGain() > 0)
+        order = juce::jmax(order, biasOversamplingOrder);
+    return order;
+}
+
+template <typename SampleType>
+void TapeMachine<SampleType>::applyOfflineProfile()
+{
+    userParams.solver = HysteresisSolver::RK4;
+    // Everything else changes the latency
+    if (offlineKeepsLatency)
+        return;
+    userParams.oversampling = maxOversamplingOrder + 1;
+    userParams.oversamplingFilter = OversamplingFilter::FIR;
+    userParams.lossFilterOrder = LossEffectFilter<SampleType>::maxFilterOrder;
+    // Nobody monitors an offline render
+    userParams.tracking = false;
+}
+
+template <typename SampleType>
+int TapeMachine<SampleType>::getLatencyInSamples() const
+{
+    float latency = oversampling != nullptr ? oversampling->getLatencyInSamples() : 0.f;
+    return juce::roundToInt(latency) + lossEffects.getLatencyInSamples() + flutter.getLatencyInSamples();
+}
+
+template <typename SampleType>
+int TapeMachine<SampleType>::getSettlingTimeInSamples() const
+{
+    // The FIR stages forget their input after their length, the oversampling filters are
+    // symmetric so that is about twice their latency. The slowest recursive part is the
+    // 35 Hz high pass; with Q = 1/sqrt(2) its response decays at pi * 35 * sqrt(2) nepers
+    // per second, so give it the time to fall by 120 dB. The hysteresis forgets its history
+    // within a few cycles of the bias tone, and the flutter delay after its longest delay.
+    const double highPassDecay = std::log(1.0e6) / (juce::MathConstants<double>::pi * 35.0 * std::sqrt(2.0));
+    float oversamplingLatency = oversampling != nullptr ? oversampling->getLatencyInSamples() : 0.f;
+    return (int) std::ceil(2.0 * oversamplingLatency + highPassDecay * sampleRate) + lossEffects.getSettlingTimeInSamples()
+           + flutter.getMaxDelayInSamples();
 }
 
-void RecordHead::processBlock (juce::dsp::AudioBlock<float>& audioBuffer)
+template <typename SampleType>
+void TapeMachine<SampleType>::setTimelinePosition(juce::int64 samples)
 {
-    auto data = audioBuffer.getChannelPointer(0);
-    for (auto i = 0; i < audioBuffer.getNumSamples(); ++i)
+    timelinePosition = samples;
+    const double seconds = (double) samples / sampleRate;
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    // Wrapping before dividing keeps the bias phase exact for whole number frequencies, even hours in
+    bias.setPhase(twoPi * std::fmod((double) samples * bias.getFrequency(), sampleRate) / sampleRate);
+    flutter.setTimelinePosition(samples);
+}
+
+template <typename SampleType>
+void TapeMachine<SampleType>::processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer)
+{
+    if (offlineRender)
+        applyOfflineProfile();
+    setOversampling(getOversamplingOrder(), getOversamplingFilter());
+
+    const size_t numSamples = audioBuffer.getNumSamples();
+    const auto inputRange = audioBuffer.findMinAndMax();
+    if (inputRange.getStart() < -silenceThreshold || inputRange.getEnd() > silenceThreshold)
+        silentSamples = 0;
+    else if (silentSamples >= getSettlingTimeInSamples())
+    {
+        // Everything the machine remembers has died away, so the output would be silence too
+        audioBuffer.clear();
+        idle = true;
+        timelinePosition += (juce::int64) numSamples;
+        profiler.beginBlock((int) numSamples);
+        profiler.endBlock();
+        return;
+    }
+    else
+        silentSamples += (juce::int64) numSamples;
+
+    // The profiler adds the sub-blocks up into one frame for the host's block
+    profiler.beginBlock((int) numSamples);
+    if (idle)
+    {
+        idle = false;
+        warmUp();
+        profiler.endStage(StageProfiler::hysteresis);
+    }
+    timelinePosition += (juce::int64) numSamples;
+    for (size_t start = 0; start < numSamples; start += (size_t) subBlockSize)
     {
-        float gwM = userParams.gapWidth * 1.0e-6;
-        float in = userParams.inputGain * data[i];
-        float out = (float)(in * turnsWire * headEfficiency) / gwM;
-        data[i] =  out;
+        auto subBlock = audioBuffer.getSubBlock(start, juce::jmin((size_t) subBlockSize, numSamples - start));
+        processSubBlock(subBlock);
     }
+    profiler.endBlock();
 }
 
-void BiasSignal::prepareToPlay (double sampleRate, int oversampling, int samplesPerBlock)
+template <typename SampleType>
+void TapeMachine<SampleType>::warmUp()
 {
-    this->samplerate = sampleRate * oversampling;
-    freq = 55000;
-    phaseIncrement = juce::MathConstants<double>::twoPi * (float) freq / (float) this->samplerate;
-    phase = 0.0;
+    // The bias tone and the flutter jump to where they would be had they kept running. Going straight on
+    // from there would hit the hysteresis and the low passes with a step of the bias, so the oversampled
+    // part of the chain runs on silence from a few bias cycles before that. It starts from cleared filters
+    // and the magnetisation the machine went idle with, whose remanence the high pass has long absorbed,
+    // and is back on the bias loop and settled by the time the input returns. Everything after the down
+    // sampler saw silence all along and is left as it is.
+    const juce::int64 resumePosition = timelinePosition;
+    const int length = (int) std::ceil(2.0 * oversampling->getLatencyInSamples() + warmUpBiasCycles * sampleRate / bias.getFrequency());
+    setTimelinePosition(resumePosition - length);
+    oversampling->reset();
+    for (auto& filter : lpf)
+        filter.reset();
+    for (int start = 0; start < length; start += subBlockSize)
+    {
+        auto block = juce::dsp::AudioBlock<SampleType>(warmUpBuffer).getSubBlock(0, (size_t) juce::jmin(subBlockSize, length - start));
+        block.clear();
+        juce::dsp::AudioBlock<SampleType> oversampledBlock = oversampling->processSamplesUp(block);
+        const int numOversampledSamples = (int) oversampledBlock.getNumSamples();
+        const SampleType* biasBlock = bias.getNextBlock(numOversampledSamples);
+        hysteresis.processBlock(oversampledBlock, biasBlock, recHead.getNextGains(numOversampledSamples), lpf);
+        oversampling->processSamplesDown(block);
+    }
+    timelinePosition = resumePosition;
+    flutter.setTimelinePosition(resumePosition);
+}
+
+template <typename SampleType>
+void TapeMachine<SampleType>::processSubBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer)
+{
+    juce::dsp::AudioBlock<SampleType> oversampledBlock = oversampling->processSamplesUp(audioBuffer);
+    profiler.endStage(StageProfiler::upsample);
+    const int numOversampledSamples = (int) oversampledBlock.getNumSamples();
+    const SampleType* biasBlock = bias.getNextBlock(numOversampledSamples);
+    profiler.endStage(StageProfiler::bias);
+    const SampleType* recordGains = recHead.getNextGains(numOversampledSamples);
+    profiler.endStage(StageProfiler::recordHead);
+    // The rest of the oversampled chain is one pass: hysteresis and low pass
+    hysteresis.processBlock(oversampledBlock, biasBlock, recordGains, lpf);
+    profiler.endStage(StageProfiler::hysteresis);
+    oversampling->processSamplesDown(audioBuffer);
+    profiler.endStage(StageProfiler::downsample);
+    // High pass and play head share a pass. The loss filter works on whole partitions,
+    // so it and the flutter delay keep their own.
+    playHead.processBlock(audioBuffer, hpf);
+    profiler.endStage(StageProfiler::playHead);
+    lossEffects.processBlock(audioBuffer);
+    profiler.endStage(StageProfiler::lossFilter);
+    flutter.processBlock(audioBuffer);
+    profiler.endStage(StageProfiler::flutter);
+}
+
+template <typename SampleType>
+void RecordHead<SampleType>::prepareToPlay (double sampleRate, int oversampling, int samplesPerBlock)
+{
+    baseSamplerate = sampleRate;
+    setOversampling(oversampling);
+    inputGain.setCurrentAndTargetValue(userParams.inputGain);
+    gains.resize((size_t) (samplesPerBlock * oversampling));
+    gapWidth = 0;
 }
 
-void BiasSignal::processBlock (juce::dsp::AudioBlock<float>& audioBuffer)
+template <typename SampleType>
+const SampleType* RecordHead<SampleType>::getNextGains (int numSamples)
 {
-    auto numSamples = audioBuffer.getNumSamples();
-    auto channelData = audioBuffer.getChannelPointer(0);
-    float g = gain * 0.5;
-    for (int sample = 0; sample < numSamples; ++sample)
+    jassert((size_t) numSamples <= gains.size());
+    if (userParams.gapWidth != gapWidth)
     {
-        const double value = std::sin(phase);
-        channelData[sample] = channelData[sample] + g * value;
-        phase += phaseIncrement;
-        if (phase >= 2.0 * M_PI)
-            phase -= 2.0 * M_PI;
+        gapWidth = userParams.gapWidth;
+        SampleType gwM = gapWidth * (SampleType) 1.0e-6;
+        headGain = turnsWire * headEfficiency / gwM;
     }
+    inputGain.setTargetValue(userParams.inputGain);
+    if (! inputGain.isSmoothing())
+    {
+        juce::FloatVectorOperations::fill(gains.data(), inputGain.getTargetValue() * headGain, numSamples);
+        return gains.data();
+    }
+    for (int i = 0; i < numSamples; ++i)
+        gains[i] = inputGain.getNextValue() * headGain;
+    return gains.data();
+}
+
+template <typename SampleType>
+void BiasSignal<SampleType>::prepareToPlay (double sampleRate, int oversampling, int samplesPerBlock)
+{
+    baseSamplerate = sampleRate;
+    setOversampling(oversampling);
+    oscillator.setFrequency(freq);
+    oscillator.setPhase(0.0);
+    tone.resize((size_t) (samplesPerBlock * oversampling));
+}
+
+template <typename SampleType>
+void BiasSignal<SampleType>::setOversampling (int oversampling)
+{
+    this->samplerate = baseSamplerate * oversampling;
+    oscillator.prepare(this->samplerate);
+}
+
+template <typename SampleType>
+const SampleType* BiasSignal<SampleType>::getNextBlock (int numSamples)
+{
+    // One oscillator drives the record head of every track, so all channels share the same bias
+    SampleType g = (SampleType) gain * (SampleType) 0.5;
+    jassert((size_t) numSamples <= tone.size());
+    oscillator.getNextBlock(tone.data(), numSamples);
+    juce::FloatVectorOperations::multiply(tone.data(), g, numSamples);
+    return tone.data();
 }
 
 //////////////////////////////////////////////////////
 //////// Hysteresis
 
-void Hysteresis::prepareToPlay (double sampleRate, int oversampling, int samplesPerBlock)
+template <typename SampleType>
+void Hysteresis<SampleType>::prepareToPlay (double sampleRate, int oversampling, int numChannels, int samplesPerBlock)
 {
-    T = (double) 1.0 / (sampleRate * oversampling);
-    Ms = 3.5e5;
-    k = 27.0e3;
-    c = 1.7e-1;
-    a = 22.0e3;
+    baseSamplerate = sampleRate;
+    setOversampling(oversampling);
+    Ms = (SampleType) 3.5e5;
+    k = (SampleType) 27.0e3;
+    c = (SampleType) 1.7e-1;
+    a = (SampleType) 22.0e3;
+    state.assign((numChannels + numLanes - 1) / numLanes, State());
+    drive.setCurrentAndTargetValue(userParams.drive);
+    inputGains.resize((size_t) (samplesPerBlock * oversampling));
  }
 
-void Hysteresis::processBlock (juce::dsp::AudioBlock<float>& audioBuffer)
-{
-    auto data = audioBuffer.getChannelPointer(0);
-    float drive = userParams.drive;
-    for (int i = 0; i < audioBuffer.getNumSamples(); i++)
-    {
-        float H = data[i] * drive * 0.5;
-        double dH = ((1.75 / T) * (H - H_1)) - 0.75 * dH_1;
-        const double H_1_2 = (H + H_1) * 0.5;
-        const double dH_1_2 = (dH + dH_1) * 0.5;
-        
-        double k1 = T * derivM(M_1, H_1, dH_1);
-        double k2 = T * derivM(M_1 + (k1 / 2.f), H_1_2, dH_1_2);
-        double k3 = T * derivM(M_1 + (k2 / 2.f), H_1_2, dH_1_2);
-        double k4 = T * derivM(M_1 + k3, H, dH);
-        float M = 0;
-        if(k1 + k2 + k3 + k4 != 0)
+template <typename SampleType>
+double Hysteresis<SampleType>::getRisingSlope(double Q) const
+{
+    // derivM is dM/dH times dH, at M = 0 all of Q comes from H
+    return (double) derivM(Lanes(0), Lanes((SampleType) (Q * a)), Lanes(1))[0] * a;
+}
+
+template <typename SampleType>
+void Hysteresis<SampleType>::setOversampling (int oversampling)
+{
+    T = (SampleType) (1.0 / (baseSamplerate * oversampling));
+    drive.reset(baseSamplerate * oversampling, UserParameters::rampLength);
+}
+
+template <typename SampleType>
+void Hysteresis<SampleType>::processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, const SampleType* bias, const SampleType* recordGain, std::vector<IIRFilter<SampleType>>& lowPass)
+{
+    // Resolve the solver once per block so the inner loop is specialised for it
+    switch (userParams.solver)
+    {
+        case HysteresisSolver::RK2: processBlock<HysteresisSolver::RK2>(audioBuffer, bias, recordGain, lowPass); break;
+        case HysteresisSolver::RK4: processBlock<HysteresisSolver::RK4>(audioBuffer, bias, recordGain, lowPass); break;
+        case HysteresisSolver::NewtonRaphson: processBlock<HysteresisSolver::NewtonRaphson>(audioBuffer, bias, recordGain, lowPass); break;
+        case HysteresisSolver::Eco: processBlock<HysteresisSolver::Eco>(audioBuffer, bias, recordGain, lowPass); break;
+    }
+}
+
+template <typename SampleType>
+template <HysteresisSolver solver>
+void Hysteresis<SampleType>::processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, const SampleType* bias, const SampleType* recordGain, std::vector<IIRFilter<SampleType>>& lowPass)
+{
+    const auto numChannels = juce::jmin(juce::jmin(audioBuffer.getNumChannels(), state.size() * numLanes), lowPass.size());
+    const auto numSamples = (int) audioBuffer.getNumSamples();
+    jassert((size_t) numSamples <= inputGains.size());
+    drive.setTargetValue(userParams.drive);
+    for (int i = 0; i < numSamples; i++)
+        inputGains[i] = recordGain[i] * drive.getNextValue() * (SampleType) 0.5;
+    for (size_t group = 0; group * numLanes < numChannels; group++)
+    {
+        SampleType* channels[numLanes];
+        for (size_t lane = 0; lane < numLanes; lane++)
+        {
+            const auto ch = group * numLanes + lane;
+            channels[lane] = ch < numChannels ? audioBuffer.getChannelPointer(ch) : nullptr;
+        }
+        Lanes H_1 = state[group].H_1;
+        Lanes dH_1 = state[group].dH_1;
+        Lanes M_1 = state[group].M_1;
+        for (int i = 0; i < numSamples; i++)
         {
-            M = M_1 + (k1 / 6.f) + (k2 / 3.f) + (k3 / 3.f) + (k4 / 6.f);
+            Lanes in;
+            for (size_t lane = 0; lane < numLanes; lane++)
+                in[lane] = channels[lane] != nullptr ? channels[lane][i] + bias[i] : SampleType();
+            Lanes H = in * inputGains[i];
+            Lanes dH = ((H - H_1) * ((SampleType) 1.75 / T)) - dH_1 * 0.75;
+            const Lanes deltaM = solve<solver>(M_1, H_1, dH_1, H, dH);
+            Lanes M = M_1 + deltaM;
+            // The eco step is exactly zero whenever the field holds still, which mustn't wipe the magnetisation
+            if constexpr (solver != HysteresisSolver::Eco)
+                M = simd::select(simd::equal(deltaM, 0.0), Lanes(0.0), M);
+            const Lanes nan = simd::isNan(M);
+            M = simd::select(nan, Lanes(0.0), M);
+            dH = simd::select(nan, Lanes(0.0), dH);
+            for (size_t lane = 0; lane < numLanes; lane++)
+                if (channels[lane] != nullptr)
+                    channels[lane][i] = lowPass[group * numLanes + lane].processSample(M[lane]);
+            dH_1 = dH;
+            H_1 = H;
+            M_1 = M;
         }
-        bool nan = std::isnan (M);
-        M = nan ? 0.0 : M;
-        dH = nan ? 0.0 : dH;
-        data[i] = M;
-        dH_1 = dH;
-        H_1 = H;
-        M_1 = M;
+        state[group] = { H_1, dH_1, M_1 };
     }
 };
 
-float Hysteresis::derivM(float M, float H, float dH)
-{
-    double Q = (H + alpha * M) * (1.f / a);
-    double cothQ = 1.0 / std::tanh(Q);
-    double oneOverQ = (double) 1.0 / Q;
-    double oneQSq = oneOverQ * oneOverQ;
-    const auto deltaS = (double) ((dH >= 0.0) - (dH < 0.0));
-    bool isNearZero = abs(Q) <= 10e-4;
-    double ManMinM = !isNearZero ? (cothQ - oneOverQ) : (double)(Q / 3.f);
-    const auto deltaM = (double) ((deltaS >= 0.f && ManMinM >= 0.f) || (deltaS < 0.f && ManMinM < 0.f));
-    double LPrimeQ = !isNearZero ? ((oneQSq) - (cothQ * cothQ) + 1.f) : (double) (1.f / 3.f);
-    double cMsOverALPrime = c * Ms / a * LPrimeQ;
-    double result = ((1.f - c) * deltaM) * ManMinM;
-    result /= ((1.f - c) * deltaS) * k - alpha * ManMinM;
-    result *= dH;
-    result += cMsOverALPrime * dH;
-    result /= (float) 1.f - cMsOverALPrime * alpha;
-    return result;
+template <typename SampleType>
+template <HysteresisSolver solver>
+typename Hysteresis<SampleType>::Lanes Hysteresis<SampleType>::solve(const Lanes& M_1, const Lanes& H_1, const Lanes& dH_1, const Lanes& H, const Lanes& dH) const
+{
+    const Lanes H_1_2 = (H + H_1) * 0.5;
+    const Lanes dH_1_2 = (dH + dH_1) * 0.5;
+    if constexpr (solver == HysteresisSolver::RK2)
+    {
+        // Midpoint method
+        Lanes k1 = derivM(M_1, H_1, dH_1) * T;
+        Lanes k2 = derivM(M_1 + (k1 * 0.5), H_1_2, dH_1_2) * T;
+        return simd::select(simd::equal(k1 + k2, 0.0), Lanes(0.0), k2);
+    }
+    else if constexpr (solver == HysteresisSolver::RK4)
+    {
+        Lanes k1 = derivM(M_1, H_1, dH_1) * T;
+        Lanes k2 = derivM(M_1 + (k1 * 0.5), H_1_2, dH_1_2) * T;
+        Lanes k3 = derivM(M_1 + (k2 * 0.5), H_1_2, dH_1_2) * T;
+        Lanes k4 = derivM(M_1 + k3, H, dH) * T;
+        return simd::select(simd::equal(k1 + k2 + k3 + k4, 0.0), Lanes(0.0), (k1 / 6.0) + (k2 / 3.0) + (k3 / 3.0) + (k4 / 6.0));
+    }
+    else if constexpr (solver == HysteresisSolver::Eco)
+    {
+        // Both ends of the step see the same alpha M, so it moves along the table's integral for its direction.
+        // Falling at Q is rising at -Q mirrored.
+        const Lanes direction = simd::greaterThanOrEqual(H - H_1, 0.0) * 2.0 - 1.0;
+        const Lanes offset = M_1 * alpha;
+        const Lanes Q = (H + offset) * (1 / a) * direction;
+        const Lanes Q_1 = (H_1 + offset) * (1 / a) * direction;
+        return (HysteresisTable::getIntegral(Q) - HysteresisTable::getIntegral(Q_1)) * direction;
+    }
+    else
+    {
+        // Trapezoidal rule, solved for M with Newton-Raphson starting from the forward Euler estimate
+        const Lanes f_1 = derivM(M_1, H_1, dH_1);
+        const Lanes halfT = T / 2;
+        Lanes M = M_1 + f_1 * T;
+        for (int iteration = 0; iteration < maxIterations; iteration++)
+        {
+            Lanes slope;
+            const Lanes f = derivM<true>(M, H, dH, slope);
+            const Lanes g = M - M_1 - (f_1 + f) * halfT;
+            const Lanes step = g / (1.0 - slope * halfT);
+            M = M - step;
+            bool converged = true;
+            for (size_t lane = 0; lane < numLanes; lane++)
+                converged = converged && std::abs(step[lane]) < tolerance;
+            if (converged)
+                break;
+        }
+        return M - M_1;
+    }
+}
+
+template <typename SampleType>
+template <bool withSlope>
+typename Hysteresis<SampleType>::Lanes Hysteresis<SampleType>::derivM(const Lanes& M, const Lanes& H, const Lanes& dH, Lanes& dMdM) const
+{
+    const Lanes Q = (H + M * alpha) * (1 / a);
+    Lanes ManMinM, LPrimeQ, LPrimePrimeQ;
+#if TAPEPM_LANGEVIN_TABLE
+    langevin.evaluate<withSlope>(Q, ManMinM, LPrimeQ, LPrimePrimeQ);
+#else
+    Langevin::evaluateExact<withSlope>(Q, ManMinM, LPrimeQ, LPrimePrimeQ);
+#endif
+    const Lanes deltaS = simd::greaterThanOrEqual(dH, 0.0) * 2.0 - 1.0;
+    const Lanes deltaM = simd::sameSign(deltaS, ManMinM);
+    const SampleType cMsOverA = c * Ms / a;
+    const Lanes cMsOverALPrime = LPrimeQ * cMsOverA;
+    const Lanes denominator = deltaS * ((1 - c) * k) - ManMinM * alpha;
+    const Lanes numerator = (deltaM * (1 - c) * ManMinM / denominator + cMsOverALPrime) * dH;
+    const Lanes scale = 1.0 - cMsOverALPrime * alpha;
+    if constexpr (withSlope)
+    {
+        // Derivative of the result with respect to M, needed by the implicit solver.
+        // deltaS and deltaM are piecewise constant and treated as such.
+        const Lanes dNumerator = (deltaM * (1 - c) * LPrimeQ * deltaS * ((1 - c) * k) / (denominator * denominator)
+                                  + LPrimePrimeQ * cMsOverA) * dH;
+        const Lanes dScale = LPrimePrimeQ * (-cMsOverA * alpha);
+        dMdM = (dNumerator * scale - numerator * dScale) / (scale * scale) * (alpha / a);
+    }
+    return numerator / scale;
 }
 
 ///////////////////////////////////////////////////////////
 ///////////// PlayHead
 
-void PlayHead::processBlock (juce::dsp::AudioBlock<float>& audioBuffer)
+template <typename SampleType>
+void PlayHead<SampleType>::prepareToPlay (double sampleRate)
 {
-    float * data = audioBuffer.getChannelPointer(0);
-    double mu0 = 4.f * M_PI * 1e-7;
-    float hwM = headWidth * 0.0254;
-    float tsM = userParams.tapeSpeed * 0.0254;
-    float gwM = userParams.gapWidth * 1.0e-6;
-    float gain = userParams.outputGain * 0.593586e7;
-    for (int i = 0; i < audioBuffer.getNumSamples(); i++)
+    outputGain.reset(sampleRate, UserParameters::rampLength);
+    outputGain.setCurrentAndTargetValue(userParams.outputGain);
+    tapeSpeed = 0;
+    gapWidth = 0;
+}
+
+template <typename SampleType>
+void PlayHead<SampleType>::processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, std::vector<IIRFilter<SampleType>>& highPass)
+{
+    if (userParams.tapeSpeed != tapeSpeed || userParams.gapWidth != gapWidth)
     {
-        float out = turnsWire * headEfficiency * gwM * hwM * mu0 * tsM * data[i];
-        out *= gain;
-        data[i] = out;
+        tapeSpeed = userParams.tapeSpeed;
+        gapWidth = userParams.gapWidth;
+        double mu0 = 4.f * M_PI * 1e-7;
+        float hwM = headWidth * 0.0254;
+        float tsM = tapeSpeed * 0.0254;
+        float gwM = gapWidth * 1.0e-6;
+        headGain = (SampleType) (turnsWire * headEfficiency * gwM * hwM * mu0 * tsM * 0.593586e7);
+    }
+    outputGain.setTargetValue(userParams.outputGain);
+    const auto numChannels = juce::jmin(audioBuffer.getNumChannels(), highPass.size());
+    const auto numSamples = (int) audioBuffer.getNumSamples();
+    if (! outputGain.isSmoothing())
+    {
+        SampleType gain = outputGain.getTargetValue() * headGain;
+        for (size_t ch = 0; ch < numChannels; ch++)
+        {
+            SampleType* data = audioBuffer.getChannelPointer(ch);
+            auto& filter = highPass[ch];
+            for (int i = 0; i < numSamples; i++)
+                data[i] = filter.processSample(data[i]) * gain;
+        }
+        return;
+    }
+    for (int i = 0; i < numSamples; i++)
+    {
+        SampleType gain = outputGain.getNextValue() * headGain;
+        for (size_t ch = 0; ch < numChannels; ch++)
+            audioBuffer.getChannelPointer(ch)[i] = highPass[ch].processSample(audioBuffer.getChannelPointer(ch)[i]) * gain;
     }
 }
 
 ///////////////////////////////////////////////////////////
 ///////////// LossEffectFilter
 
-void LossEffectFilter::prepareToPlay(double sampleRate, int samplesPerBlock)
+template <typename SampleType>
+LossEffectFilter<SampleType>::~LossEffectFilter()
 {
+    coefficientThread->removeTimeSliceClient(this);
+}
+
+template <typename SampleType>
+void LossEffectFilter<SampleType>::prepareToPlay(double sampleRate, int numChannels, int samplesPerBlock)
+{
+    coefficientThread->removeTimeSliceClient(this);
     this->samplerate = sampleRate;
     this->samplesPerBlock = samplesPerBlock;
-    filter.prepare({sampleRate, (juce::uint32)samplesPerBlock, 1});
-    calculateCoefficients(samplesPerBlock);
+    convolvers.resize(numChannels);
+    for (auto& convolver : convolvers)
+        convolver.prepare(partitionSize, maxFilterOrder);
+    lastRequestedKey = getCurrentKey();
+    rebuildRequested = false;
+    rebuildCoefficients();
+    for (auto& convolver : convolvers)
+        convolver.setKernel(latestKernel.load());
+    acknowledgedKernel = latestKernel.load();
+    coefficientThread->addTimeSliceClient(this);
+}
+
+template <typename SampleType>
+void LossEffectFilter<SampleType>::processBlock(juce::dsp::AudioBlock<SampleType>& audioBuffer)
+{
+    auto key = getCurrentKey();
+    if (key != lastRequestedKey)
+    {
+        lastRequestedKey = key;
+        if (rebuildOnAudioThread)
+        {
+            // Under the lock, so a request still pending on the coefficient thread finds this key built
+            const juce::ScopedLock sl(calculationLock);
+            setRequestedKey(key);
+            cachedKey = key;
+            publishCoefficients(calculateCoefficients(key));
+        }
+        else
+        {
+            setRequestedKey(key);
+            rebuildRequested.store(true, std::memory_order_release);
+        }
+    }
+    // Only swaps a pointer; the pool still owns the previous kernel, so nothing is freed here.
+    auto* latest = latestKernel.load(std::memory_order_acquire);
+    auto numChannels = juce::jmin(audioBuffer.getNumChannels(), convolvers.size());
+    for (size_t ch = 0; ch < numChannels; ch++)
+    {
+        if (latest != nullptr)
+            convolvers[ch].setKernel(latest);
+        convolvers[ch].process(audioBuffer.getChannelPointer(ch), (int) audioBuffer.getNumSamples());
+    }
+    // Every convolver holds a reference to latest now, the kernels before it can go
+    if (latest != nullptr)
+        acknowledgedKernel.store(latest, std::memory_order_release);
+}
+
+template <typename SampleType>
+void LossEffectFilter<SampleType>::setRequestedKey(const CoefficientKey& key)
+{
+    requestedTapeSpeed = key.tapeSpeed;
+    requestedSpacing = key.spacingTapeHead;
+    requestedThickness = key.tapeThickness;
+    requestedGap = key.gapWidth;
+    requestedFilterOrder = key.filterOrder;
+    requestedMinimumPhase = key.minimumPhase;
+}
+
+template <typename SampleType>
+void LossEffectFilter<SampleType>::rebuildCoefficients()
+{
+    auto key = getCurrentKey();
+    const juce::ScopedLock sl(calculationLock);
+    cachedKey = key;
+    publishCoefficients(calculateCoefficients(key));
+}
+
+template <typename SampleType>
+typename LossEffectFilter<SampleType>::CoefficientKey LossEffectFilter<SampleType>::getCurrentKey() const
+{
+    CoefficientKey key;
+    key.tapeSpeed = params.tapeSpeed;
+    key.spacingTapeHead = params.spacingTapeHead;
+    key.tapeThickness = params.tapeThickness;
+    key.gapWidth = params.gapWidth;
+    key.filterOrder = getFilterOrder();
+    key.minimumPhase = params.tracking;
+    key.samplerate = samplerate;
+    return key;
 }
 
-void LossEffectFilter::processBlock(juce::dsp::AudioBlock<float>& audioBuffer)
+template <typename SampleType>
+int LossEffectFilter<SampleType>::useTimeSlice()
 {
-    calculateCoefficients(samplesPerBlock);
-    auto data = audioBuffer.getChannelPointer(0);
-    for (int i = 0; i < audioBuffer.getNumSamples(); i++)
+    if (rebuildRequested.exchange(false, std::memory_order_acquire))
     {
-        data[i] = filter.processSample(data[i]);
+        const juce::ScopedLock sl(calculationLock);
+        CoefficientKey key;
+        key.tapeSpeed = requestedTapeSpeed;
+        key.spacingTapeHead = requestedSpacing;
+        key.tapeThickness = requestedThickness;
+        key.gapWidth = requestedGap;
+        key.filterOrder = requestedFilterOrder;
+        key.minimumPhase = requestedMinimumPhase;
+        key.samplerate = samplerate;
+        if (key != cachedKey)
+        {
+            cachedKey = key;
+            publishCoefficients(calculateCoefficients(key));
+        }
     }
+    return 20;
+}
+
+template <typename SampleType>
+void LossEffectFilter<SampleType>::publishCoefficients(typename Kernel::Ptr newKernel)
+{
+    kernelPool.add(newKernel);
+    latestKernel.store(newKernel.get(), std::memory_order_release);
+    // The pool is in publishing order. The audio thread only ever loads the latest kernel, so
+    // once it has acknowledged one it never picks up an older one again; the kernels between
+    // the acknowledged one and the latest may be loaded but not yet referenced and must stay.
+    const int acknowledged = kernelPool.indexOf(acknowledgedKernel.load(std::memory_order_acquire));
+    for (int i = acknowledged - 1; i >= 0; --i)
+        if (kernelPool.getObjectPointerUnchecked(i)->getReferenceCount() == 1)
+            kernelPool.remove(i);
 }
 
-void LossEffectFilter::calculateCoefficients(int samplesPerBlock)
+template <typename SampleType>
+typename LossEffectFilter<SampleType>::Kernel::Ptr LossEffectFilter<SampleType>::calculateCoefficients(const CoefficientKey& key)
 {
-    binWidth = samplerate / (float) filterOrder;
-    H.resize(filterOrder);
-    float tapeSpeed = params.tapeSpeed * 0.0254; // * 0.0254 to convert from ips to meter per second
-    float spacing = params.spacingTapeHead * 1.0e-6; // microns to meters
-    float thickness = params.tapeThickness * 1.0e-6;
-    float gap = params.gapWidth * 1.0e-6;
-    for (int n = 0; n < filterOrder; n++)
+    const int filterOrder = key.filterOrder;
+    coefficients.clearQuick();
+    coefficients.ensureStorageAllocated(filterOrder);
+    if (key.minimumPhase)
+        designMinimumPhase(key);
+    else
     {
+        if (fft == nullptr || fft->getSize() != filterOrder)
+            fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(filterOrder)));
+        binWidth = key.samplerate / (float) filterOrder;
+        H.resize(filterOrder);
         auto hData = H.data();
-        float f = n == 0 ? 20.0 : binWidth * n;
-        float k = (juce::MathConstants<float>::twoPi * f) / (tapeSpeed);
-        float magnitude = 0;
-        magnitude = exp(-k * spacing);
-        float kThickness = k * thickness;
-        magnitude *= (1 - exp(-kThickness)) / kThickness;
-        float kGapHalf = k * gap * 0.5;
-        magnitude *= sin(kGapHalf) / kGapHalf;
-        hData[n] = {magnitude, 0};
-    }
-    timeDomainData.clear();
-    timeDomainData = std::vector<std::complex<float>>();
+        for (int n = 0; n <= filterOrder / 2; n++)
+        {
+            float magnitude = getLossResponse(n == 0 ? 20.0 : binWidth * n, key);
+            hData[n] = {magnitude, 0};
+            // Mirror the response so the impulse response is real
+            if (n > 0 && n < filterOrder / 2)
+                hData[filterOrder - n] = {magnitude, 0};
+        }
+        designLinearPhase(filterOrder);
+    }
+    float dcGain = 0;
+    for (auto coefficient : coefficients)
+        dcGain += coefficient;
+    // Windowing changes the low frequency gain depending on the length. Pin it to the
+    // designed response so every filter order and both phase responses sound equally loud.
+    if (dcGain != 0)
+        for (auto& coefficient : coefficients)
+            coefficient *= baselineGain * getLossResponse(20.0, key) / dcGain;
+    return new Kernel(coefficients.getRawDataPointer(), coefficients.size(), partitionSize);
+}
+
+template <typename SampleType>
+float LossEffectFilter<SampleType>::getLossResponse(float frequency, const CoefficientKey& key)
+{
+    float tapeSpeed = key.tapeSpeed * 0.0254; // * 0.0254 to convert from ips to meter per second
+    float spacing = key.spacingTapeHead * 1.0e-6; // microns to meters
+    float thickness = key.tapeThickness * 1.0e-6;
+    float gap = key.gapWidth * 1.0e-6;
+    float k = (juce::MathConstants<float>::twoPi * frequency) / (tapeSpeed);
+    float magnitude = 0;
+    magnitude = exp(-k * spacing);
+    float kThickness = k * thickness;
+    magnitude *= (1 - exp(-kThickness)) / kThickness;
+    float kGapHalf = k * gap * 0.5;
+    magnitude *= sin(kGapHalf) / kGapHalf;
+    return magnitude;
+}
+
+template <typename SampleType>
+void LossEffectFilter<SampleType>::designLinearPhase(int filterOrder)
+{
     timeDomainData.resize(filterOrder);
     fft->perform(H.getRawDataPointer(), timeDomainData.data(), true);
-    coefficients.clear();
-    coefficients.ensureStorageAllocated(filterOrder);
+    // The zero phase response wraps around the start of the buffer. Centre it
+    // and window it, which makes the filter linear phase with a delay of filterOrder / 2.
+    for (int i = 0; i < filterOrder; i++)
+    {
+        float window = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * i / (float) filterOrder);
+        coefficients.add(timeDomainData[(i + filterOrder / 2) % filterOrder].real() * window);
+    }
+}
+
+template <typename SampleType>
+void LossEffectFilter<SampleType>::designMinimumPhase(const CoefficientKey& key)
+{
+    // Folding the real cepstrum of the log magnitude onto positive quefrencies gives the
+    // cepstrum of the minimum phase filter with that magnitude. It has the same losses
+    // as the linear phase filter, with its energy at the start instead of the middle.
+    const int filterOrder = key.filterOrder;
+    const int size = filterOrder * minimumPhaseOversampling;
+    if (minimumPhaseFft == nullptr || minimumPhaseFft->getSize() != size)
+        minimumPhaseFft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(size)));
+    spectrum.resize(size);
+    cepstrum.resize(size);
+    const float gridWidth = key.samplerate / (float) size;
+    for (int n = 0; n <= size / 2; n++)
+    {
+        // The gap nulls would take the log to minus infinity, -120 dB is deep enough
+        float magnitude = juce::jmax(1.0e-6f, std::abs(getLossResponse(n == 0 ? 20.0 : gridWidth * n, key)));
+        spectrum[n] = {std::log(magnitude), 0};
+        if (n > 0 && n < size / 2)
+            spectrum[size - n] = spectrum[n];
+    }
+    minimumPhaseFft->perform(spectrum.data(), cepstrum.data(), true);
+    for (int n = 1; n < size; n++)
+    {
+        if (n < size / 2)
+            cepstrum[n] *= 2.f;
+        else if (n > size / 2)
+            cepstrum[n] = 0;
+    }
+    minimumPhaseFft->perform(cepstrum.data(), spectrum.data(), false);
+    for (auto& bin : spectrum)
+        bin = std::exp(bin);
+    minimumPhaseFft->perform(spectrum.data(), cepstrum.data(), true);
+    // Fade out the end with the falling half of a Hann window
     for (int i = 0; i < filterOrder; i++)
     {
-        coefficients.add(timeDomainData[i].real());
+        float window = 0.5f + 0.5f * std::cos(juce::MathConstants<float>::pi * i / (float) filterOrder);
+        coefficients.add(cepstrum[i].real() * window);
     }
-    coef = new juce::dsp::FIR::Coefficients<float>(coefficients.getRawDataPointer(), coefficients.size());
-    filter.coefficients = coef.get();
 }
+
+template class RecordHead<float>;
+template class RecordHead<double>;
+template class BiasSignal<float>;
+template class BiasSignal<double>;
+template class Hysteresis<float>;
+template class Hysteresis<double>;
+template class PlayHead<float>;
+template class PlayHead<double>;
+template class LossEffectFilter<float>;
+template class LossEffectFilter<double>;
+template class TapeMachine<float>;
+template class TapeMachine<double>;
@@ -13,111 +13,347 @@
 #include <JuceHeader.h>
 #include "Parameters.h"
 #include "ModDelay.h"
+#include "Convolver.h"
+#include "SIMDLanes.h"
+#include "Langevin.h"
+#include "HysteresisTable.h"
+#include "Oscillator.h"
+#include "StageProfiler.h"
 
+/*  Every stage that touches audio is a template on the sample type, float or double,
+    and is instantiated for both at the end of TapeSim.cpp. The float machine does its
+    maths in float throughout, the double one in double.
+*/
+
+template <typename SampleType>
+using IIRFilter = juce::dsp::IIR::Filter<SampleType>;
+
+template <typename SampleType>
 class RecordHead
 {
 public:
     RecordHead(UserParameters& userParams) : userParams(userParams) { };
-    void processBlock (juce::dsp::AudioBlock<float>& audioBuffer);
+    void prepareToPlay (double sampleRate, int oversampling, int samplesPerBlock);
+    // Gain from input voltage to head field for the next numSamples samples, applied by the hysteresis
+    const SampleType* getNextGains (int numSamples);
+    void setOversampling (int oversampling) { inputGain.reset(baseSamplerate * oversampling, UserParameters::rampLength); };
 private:
-    float turnsWire = 100.f;
-    float headEfficiency = 0.1;
+    SampleType turnsWire = 100;
+    SampleType headEfficiency = (SampleType) 0.1;
+    double baseSamplerate = 44100;
+    // Only recomputed when the gap width changes
+    float gapWidth = 0;
+    SampleType headGain = 0;
+    juce::SmoothedValue<SampleType> inputGain;
+    std::vector<SampleType> gains;
     UserParameters& userParams;
 };
 
+template <typename SampleType>
 class BiasSignal
 {
 public:
     void prepareToPlay (double sampleRate, int oversampling, int samplesPerBlock);
-    void processBlock (juce::dsp::AudioBlock<float>& audioBuffer);
+    // The next numSamples samples of the bias tone, shared by every channel
+    const SampleType* getNextBlock (int numSamples);
+    void setOversampling (int oversampling);
     void setGain(float gain) { this->gain = gain; };
+    float getGain() const { return gain; };
+    float getFrequency() const { return freq; };
+    void setPhase(double phase) { oscillator.setPhase(phase); };
 private:
-    float samplerate;
-    float gain;
-    float freq;
-    double phase;
-    double phaseIncrement;
-
+    double baseSamplerate = 44100;
+    float samplerate = 44100;
+    // Full bias until the host sets it, as in the plugin's default
+    float gain = 1.f;
+    float freq = 55000;
+    Oscillator oscillator;
+    std::vector<SampleType> tone;
 };
 
+template <typename SampleType>
 class Hysteresis
 {
 public:
     Hysteresis(UserParameters& params) : userParams(params) {};
-    void prepareToPlay (double sampleRate, int oversampling, int samplesPerBlock);
-    void processBlock (juce::dsp::AudioBlock<float>& audioBuffer);
+    void prepareToPlay (double sampleRate, int oversampling, int numChannels, int samplesPerBlock);
+    /** Runs bias, record head, hysteresis and low pass in a single pass over the oversampled block.
+        The field is (input + bias) * recordGain, every result goes through its channel's filter.
+    */
+    void processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, const SampleType* bias, const SampleType* recordGain, std::vector<IIRFilter<SampleType>>& lowPass);
+    void setOversampling (int oversampling);
+    // Upper bound for the Newton-Raphson iterations per sample
+    void setMaxIterations(int iterations) { maxIterations = juce::jmax(1, iterations); };
+    // dM/dH of the model times a while the field rises at Q = (H + alpha M) / a. Tools/hysteresis-table builds the eco table from it.
+    double getRisingSlope(double Q) const;
 private:
-    float derivM(float M, float H, float dH);
+    // Channels are solved in groups, one channel per lane. Floats use as many lanes as doubles: the
+    // table lookups and divisions run per lane either way, and wider groups would leave stereo half empty.
+    static constexpr size_t numLanes = juce::dsp::SIMDRegister<double>::SIMDNumElements;
+    using Lanes = SIMDLanes<SampleType, numLanes>;
+
+    template <HysteresisSolver solver>
+    void processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, const SampleType* bias, const SampleType* recordGain, std::vector<IIRFilter<SampleType>>& lowPass);
+    template <HysteresisSolver solver>
+    Lanes solve(const Lanes& M_1, const Lanes& H_1, const Lanes& dH_1, const Lanes& H, const Lanes& dH) const;
+    template <bool withSlope>
+    Lanes derivM(const Lanes& M, const Lanes& H, const Lanes& dH, Lanes& dMdM) const;
+    Lanes derivM(const Lanes& M, const Lanes& H, const Lanes& dH) const { Lanes unused; return derivM<false>(M, H, dH, unused); };
     
-    double Ms = 1.0;
-    double a = Ms / 4.0;
-    double c = 1.7e-1;
-    double k = 0.47875;
-    double alpha = 1.6e-3;
-    float H_1 = 0;
-    float dH_1 = 0;
-    float M_1 = 0;
-    double T;
+    SampleType Ms = 1;
+    SampleType a = Ms / 4;
+    SampleType c = (SampleType) 1.7e-1;
+    SampleType k = (SampleType) 0.47875;
+    SampleType alpha = (SampleType) 1.6e-3;
+    struct State
+    {
+        Lanes H_1 = 0.0;
+        Lanes dH_1 = 0.0;
+        Lanes M_1 = 0.0;
+    };
+    std::vector<State> state;
+    juce::SmoothedValue<SampleType> drive;
+    // Per sample record and drive gain of the current block, shared by every channel group
+    std::vector<SampleType> inputGains;
+    double baseSamplerate;
+    SampleType T;
+    int maxIterations = 8;
+    // Newton-Raphson stops once every step is below this. Near saturation M in float only resolves about 0.03.
+    static constexpr SampleType tolerance = std::is_same_v<SampleType, float> ? 0.25 : 1.0e-3;
+    // Shared by every instance, built by the first one
+    const Langevin& langevin = Langevin::get();
     UserParameters& userParams;
 };
 
+template <typename SampleType>
 class PlayHead
 {
 public:
     PlayHead(UserParameters& params) : userParams(params) { };
-    void processBlock (juce::dsp::AudioBlock<float>& audioBuffer);
+    void prepareToPlay (double sampleRate);
+    // Filters each channel through its high pass and applies the head gain in the same pass
+    void processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer, std::vector<IIRFilter<SampleType>>& highPass);
 private:
     UserParameters& userParams;
+    juce::SmoothedValue<SampleType> outputGain;
+    // Only recomputed when tape speed or gap width change
+    float tapeSpeed = 0;
+    float gapWidth = 0;
+    SampleType headGain = 0;
     float headWidth = 0.125;
     float turnsWire = 100.f;
     float headEfficiency = 0.1;
 };
 
-class LossEffectFilter
+/** Background thread shared by all plugin instances, used to rebuild filter
+    coefficients away from the audio thread.
+*/
+class CoefficientThread : public juce::TimeSliceThread
 {
 public:
-    LossEffectFilter(UserParameters& userParams) : params(userParams) {
-        fft = std::make_unique<juce::dsp::FFT>(7);
-        filter = juce::dsp::FIR::Filter<float>();
-    };
-    void prepareToPlay(double sampleRate, int samplesPerBlock);
-    void processBlock(juce::dsp::AudioBlock<float>& audioBuffer);
-    void calculateCoefficients(int samplesPerBlock);
+    CoefficientThread() : juce::TimeSliceThread("Tape coefficient builder") { startThread(); };
+    ~CoefficientThread() override { stopThread(1000); };
+};
+
+/** The head losses as a convolution. The response is designed in float whatever the
+    sample type, only the convolvers run in it.
+*/
+template <typename SampleType>
+class LossEffectFilter : private juce::TimeSliceClient
+{
+public:
+    LossEffectFilter(UserParameters& userParams) : params(userParams) { };
+    ~LossEffectFilter() override;
+    void prepareToPlay(double sampleRate, int numChannels, int samplesPerBlock);
+    void processBlock(juce::dsp::AudioBlock<SampleType>& audioBuffer);
+    // Designs the kernel for the current parameters on the calling thread, never call it from a real-time audio thread
+    void rebuildCoefficients();
+    // Offline the kernel is rebuilt within the block that changed it, so a render doesn't depend on the coefficient thread
+    void setRebuildOnAudioThread(bool shouldRebuildOnAudioThread) { rebuildOnAudioThread = shouldRebuildOnAudioThread; };
+    // The response is linear phase, centred on the middle tap, or minimum phase while tracking
+    int getLatencyInSamples() const { return params.tracking ? 0 : getFilterOrder() / 2; };
+    // The filter only remembers as many samples as it has taps
+    int getSettlingTimeInSamples() const { return getFilterOrder(); };
+    /** The first design took the real part of a one-sided spectrum, which passes every bin but DC
+        at half its level. Existing sessions are balanced for that, so the loss filter keeps the -6 dB.
+    */
+    static constexpr float baselineGain = 0.5f;
+    static constexpr int minFilterOrder = 1 << 6;
+    static constexpr int maxFilterOrder = 1 << 12;
 private:
+    using Kernel = typename PartitionedConvolver<SampleType>::Kernel;
+    // The parameters the loss response depends on. Coefficients are only rebuilt when these change.
+    struct CoefficientKey
+    {
+        float tapeSpeed = 0;
+        float spacingTapeHead = 0;
+        float tapeThickness = 0;
+        float gapWidth = 0;
+        int filterOrder = 0;
+        double samplerate = 0;
+        bool minimumPhase = false;
+        bool operator== (const CoefficientKey& other) const
+        {
+            return tapeSpeed == other.tapeSpeed && spacingTapeHead == other.spacingTapeHead
+                && tapeThickness == other.tapeThickness && gapWidth == other.gapWidth
+                && filterOrder == other.filterOrder && samplerate == other.samplerate
+                && minimumPhase == other.minimumPhase;
+        }
+        bool operator!= (const CoefficientKey& other) const { return ! (*this == other); }
+    };
+    CoefficientKey getCurrentKey() const;
+    void setRequestedKey(const CoefficientKey& key);
+    int getFilterOrder() const { return juce::jlimit(minFilterOrder, maxFilterOrder, juce::nextPowerOfTwo(params.lossFilterOrder)); };
+    typename Kernel::Ptr calculateCoefficients(const CoefficientKey& key);
+    // Magnitude of the head losses, signed: the gap loss changes sign past each of its nulls
+    static float getLossResponse(float frequency, const CoefficientKey& key);
+    void designLinearPhase(int filterOrder);
+    void designMinimumPhase(const CoefficientKey& key);
+    void publishCoefficients(typename Kernel::Ptr newKernel);
+    int useTimeSlice() override;
+
     float samplerate;
-    int filterOrder = 1 << 7;
+    int partitionSize = 1 << 6;
     float binWidth;
     juce::Array<std::complex<float>> H;
-    juce::dsp::FIR::Coefficients<float>::Ptr coef;
     UserParameters &params;
-    juce::dsp::FIR::Filter<float> filter;
+    std::vector<PartitionedConvolver<SampleType>> convolvers;
     juce::Array<float> coefficients;
     std::unique_ptr<juce::dsp::FFT> fft;
     std::vector<std::complex<float>> timeDomainData;
+    // The minimum phase design works on a grid this many times finer than the filter
+    static constexpr int minimumPhaseOversampling = 4;
+    std::unique_ptr<juce::dsp::FFT> minimumPhaseFft;
+    std::vector<std::complex<float>> spectrum;
+    std::vector<std::complex<float>> cepstrum;
     int samplesPerBlock;
+
+    // Written by the audio thread when the parameters differ from the last request,
+    // picked up by the coefficient thread.
+    std::atomic<float> requestedTapeSpeed { 0 };
+    std::atomic<float> requestedSpacing { 0 };
+    std::atomic<float> requestedThickness { 0 };
+    std::atomic<float> requestedGap { 0 };
+    std::atomic<int> requestedFilterOrder { 0 };
+    std::atomic<bool> requestedMinimumPhase { false };
+    std::atomic<bool> rebuildRequested { false };
+    CoefficientKey lastRequestedKey;
+    bool rebuildOnAudioThread = false;
+
+    // Kernels handed to the audio thread. The pool keeps every published kernel alive
+    // so the audio thread never drops the last reference; stale kernels are freed on the coefficient thread.
+    std::atomic<Kernel*> latestKernel { nullptr };
+    // The last kernel the audio thread took a reference to. Kernels published after it may
+    // still be loaded but not yet referenced, so only the ones before it can be freed.
+    std::atomic<Kernel*> acknowledgedKernel { nullptr };
+    juce::ReferenceCountedArray<Kernel> kernelPool;
+    juce::CriticalSection calculationLock;
+    CoefficientKey cachedKey;
+    juce::SharedResourcePointer<CoefficientThread> coefficientThread;
 };
 
+template <typename SampleType>
 class TapeMachine
 {
 public:
     TapeMachine();
     void prepareToPlay (double sampleRate, int totalNumOutputChannels, int samplesPerBlock);
-    void processBlock (juce::dsp::AudioBlock<float>& audioBuffer);
+    // Takes blocks of any length, longer ones than the sub-block size are split
+    void processBlock (juce::dsp::AudioBlock<SampleType>& audioBuffer);
 
-    RecordHead& getRecordHead () { return recHead; };
-    BiasSignal& getBiasSignal () { return bias; };
+    RecordHead<SampleType>& getRecordHead () { return recHead; };
+    BiasSignal<SampleType>& getBiasSignal () { return bias; };
     UserParameters& getUserParams() { return userParams; };
+    StageProfiler& getProfiler() { return profiler; };
     
     void setUserParams(UserParameters &userParams) { this->userParams = userParams; };
+    int getOversamplingFactor() const { return 1 << oversamplingOrder; };
+    // Latency of the current configuration in samples at the host rate
+    int getLatencyInSamples() const;
+    // Samples of input after which the output no longer depends on what came before
+    int getSettlingTimeInSamples() const;
+    /** Moves the oscillators to where they would be after this many samples of playback, call it after prepareToPlay.
+        A render starting part way through a file then lines up with one that started at the beginning.
+    */
+    void setTimelinePosition(juce::int64 samples);
+    /** Whether the last block was skipped. Once the input has been silent for the settling time
+        the output is silence too, so blocks are cleared instead of processed until the input returns.
+    */
+    bool isIdle() const { return idle; };
+    /** Offline renders trade CPU for accuracy: RK4, and unless keepLatency is set, 16x FIR oversampling
+        and the longest loss filter. A plugin keeps its latency, hosts don't pick up a new one in the middle of a bounce.
+    */
+    void setOfflineRender(bool shouldRenderOffline, bool keepLatency = false) { offlineRender = shouldRenderOffline; offlineKeepsLatency = keepLatency; };
+    bool isOfflineRender() const { return offlineRender; };
+    /** Without a real-time deadline, parameter changes take effect within the block instead of
+        waiting for the coefficient thread, so renders come out the same every time.
+    */
+    void setNonRealtime(bool isNonRealtime) { lossEffects.setRebuildOnAudioThread(isNonRealtime); };
+    /** Auto oversampling keeps aliased harmonics below this level at the drive of prepareToPlay. Whatever
+        the choice, while there is bias the factor doesn't drop below the one that keeps the bias tone below Nyquist.
+    */
+    void setAliasingThreshold(float decibels) { aliasingThresholdDb = decibels; };
+    /** The stages run on at most this many samples at a time, whatever the host's block size.
+        At 16x the default keeps each oversampled buffer at 8 kB per channel in float. Call it before prepareToPlay.
+    */
+    void setMaxSubBlockSize(int samples) { maxSubBlockSize = juce::jlimit(minSubBlockSize, maxSubBlockSizeLimit, samples); };
+    static constexpr int defaultSubBlockSize = 128;
+    static constexpr int minSubBlockSize = 16;
+    static constexpr int maxSubBlockSizeLimit = 4096;
 private:
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversampling;
-    RecordHead recHead;
-    BiasSignal bias;
-    Hysteresis hysteresis;
-    LossEffectFilter lossEffects;
-    PlayHead playHead;
-    juce::dsp::ProcessorDuplicator <juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients <float>> hpf;
-    juce::dsp::IIR::Filter<float> lpf;
+    static constexpr int maxOversamplingOrder = 4;
+    static constexpr int numOversamplingFilters = 2;
+    void processSubBlock(juce::dsp::AudioBlock<SampleType>& audioBuffer);
+    void warmUp();
+    int chooseOversamplingOrder() const;
+    // Lowest order whose oversampled rate reaches requiredRate
+    int getLowestOrderFor(double requiredRate) const;
+    // The chosen order, raised to the bias safe one while there is bias
+    int getOversamplingOrder() const;
+    void applyOfflineProfile();
+    void setOversampling(int order, OversamplingFilter filter);
+    // Tracking always uses the IIR filters, they add next to no latency
+    OversamplingFilter getOversamplingFilter() const { return userParams.tracking ? OversamplingFilter::IIR : userParams.oversamplingFilter; };
+
+    // Every factor and filter type is built in prepareToPlay, so the audio thread can switch without allocating
+    using Coefficients = juce::dsp::IIR::Coefficients<SampleType>;
+    std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, (maxOversamplingOrder + 1) * numOversamplingFilters> oversamplers;
+    std::array<typename Coefficients::Ptr, maxOversamplingOrder + 1> lpfCoefficients;
+    juce::dsp::Oversampling<SampleType>* oversampling = nullptr;
+    int oversamplingOrder = maxOversamplingOrder;
+    OversamplingFilter oversamplingFilter = OversamplingFilter::FIR;
+    float aliasingThresholdDb = -60.f;
+    bool offlineRender = false;
+    bool offlineKeepsLatency = false;
+    // The factor Auto chose in prepareToPlay, drive changes while playing don't switch it
+    int autoOversamplingOrder = maxOversamplingOrder;
+    // Lowest order that keeps the bias tone and its sidebands below Nyquist
+    int biasOversamplingOrder = maxOversamplingOrder;
+    // Anything quieter than one step of 24 bit audio counts as silence
+    static constexpr SampleType silenceThreshold = (SampleType) 1.0e-7;
+    juce::int64 silentSamples = 0;
+    bool idle = false;
+    // Samples played since prepareToPlay or setTimelinePosition, the oscillators pick up from here after idling
+    juce::int64 timelinePosition = 0;
+    // Bias cycles the hysteresis gets to forget the jump of the bias phase when the input returns
+    static constexpr double warmUpBiasCycles = 16.0;
+    // Silence for the warm-up, one sub-block of every channel
+    juce::AudioBuffer<SampleType> warmUpBuffer;
+    int maxSubBlockSize = defaultSubBlockSize;
+    // What the stages were prepared for, no more than maxSubBlockSize
+    int subBlockSize = defaultSubBlockSize;
+    double sampleRate = 44100;
+    RecordHead<SampleType> recHead;
+    BiasSignal<SampleType> bias;
+    Hysteresis<SampleType> hysteresis;
+    LossEffectFilter<SampleType> lossEffects;
+    PlayHead<SampleType> playHead;
+    // One filter per channel, all sharing the coefficients object
+    typename Coefficients::Ptr hpfCoefficients;
+    typename Coefficients::Ptr lpfState;
+    std::vector<IIRFilter<SampleType>> hpf;
+    std::vector<IIRFilter<SampleType>> lpf;
     UserParameters userParams;
-    ModDelay flutter;
+    ModDelay<SampleType> flutter;
+    StageProfiler profiler;
 };
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    WowFlutter.cpp
+    Created: 17 Oct 2026 10:18:52pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include "WowFlutter.h"
+
+namespace
+{
+    // Capstan harmonics and the pinch roller relative to the capstan, in speed deviation
+    constexpr float secondHarmonicDepth = 0.3f;
+    constexpr float thirdHarmonicDepth = 0.15f;
+    constexpr float pinchRollerDepth = 0.5f;
+    // The roller is about three times the diameter of the capstan
+    constexpr double pinchRollerRatio = 0.3;
+    constexpr double scrapeFrequency = 500.0;
+    constexpr double scrapeQ = 1.0;
+    // Peaks of the filtered noise, in multiples of its RMS, that still have to fit the excursion
+    constexpr float scrapeCrestFactor = 3.f;
+    // The delay a component needs grows without bound as it slows down. Below these rates
+    // the depth gives the excursion it gives at them, which bounds the delay line.
+    constexpr double minFlutterRate = 2.0;
+    constexpr double minWowRate = 0.25;
+}
+
+double WowFlutter::getMaxExcursion()
+{
+    // Every component at the top of its range and at the slowest rate it gets the full excursion at
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    const double flutter = UserParameters::maxFlutterSpeedDeviation / (twoPi * minFlutterRate)
+                           * (1.0 + secondHarmonicDepth / 2.0 + thirdHarmonicDepth / 3.0 + pinchRollerDepth / pinchRollerRatio);
+    const double wow = UserParameters::maxWowSpeedDeviation / (twoPi * minWowRate);
+    const double scrape = scrapeCrestFactor * UserParameters::maxScrapeSpeedDeviation / (twoPi * scrapeFrequency);
+    return flutter + wow + scrape;
+}
+
+void WowFlutter::prepare(double sampleRate, double maxExcursionSamples)
+{
+    this->sampleRate = sampleRate;
+    controlRate = sampleRate / controlInterval;
+    maxExcursion = (float) maxExcursionSamples;
+    for (auto& oscillator : oscillators)
+        oscillator.prepare(controlRate);
+    for (auto& amplitude : amplitudes)
+        amplitude.reset(controlRate, UserParameters::rampLength);
+    scrapeAmplitude.reset(controlRate, UserParameters::rampLength);
+    // The scrape band has to stay well below the control rate's Nyquist for the interpolation to pass it
+    const double centre = juce::jmin(scrapeFrequency, controlRate * 0.25);
+    scrapeFilter.coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(controlRate, centre, scrapeQ);
+    scrapeFilter.prepare({ controlRate, 1, 1 });
+    // Uniform noise has a variance of 1/3, the band pass passes pi f / (Q fs) of it
+    scrapeNormalisation = (float) (1.0 / std::sqrt(juce::MathConstants<double>::pi * centre / (scrapeQ * controlRate) / 3.0));
+    updateTargets();
+    for (auto& amplitude : amplitudes)
+        amplitude.setCurrentAndTargetValue(amplitude.getTargetValue());
+    scrapeAmplitude.setCurrentAndTargetValue(scrapeAmplitude.getTargetValue());
+    setTimelinePosition(0);
+}
+
+void WowFlutter::updateTargets()
+{
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    // A speed deviation of depth at rate moves the delay by depth * sampleRate / (2 pi rate)
+    auto excursion = [&] (double depth, double rate) { return (float) (depth * sampleRate / (twoPi * rate)); };
+    const double wowRate = params.wowRate;
+    const double flutterRate = params.flutterRate;
+    // Each range maps linearly onto the speed deviation up to its maximum
+    auto speedDeviation = [] (float depth, float maxDepth, float maxDeviation) { return juce::jlimit(0.0, 1.0, (double) (depth / maxDepth)) * maxDeviation; };
+    const double wowDepth = wowRate > 0 ? speedDeviation(params.wowDepth, UserParameters::maxWowDepth, UserParameters::maxWowSpeedDeviation) : 0.0;
+    const double flutterDepth = flutterRate > 0 ? speedDeviation(params.flutterDepth, UserParameters::maxFlutterDepth, UserParameters::maxFlutterSpeedDeviation) : 0.0;
+    const double scrapeDepth = speedDeviation(params.scrapeFlutter, UserParameters::maxScrapeFlutter, UserParameters::maxScrapeSpeedDeviation);
+    const double wowExcursionRate = juce::jmax(wowRate, minWowRate);
+    const double flutterExcursionRate = juce::jmax(flutterRate, minFlutterRate);
+    oscillators[wow].setFrequency(wowRate);
+    oscillators[capstan].setFrequency(flutterRate);
+    oscillators[capstanSecond].setFrequency(2.0 * flutterRate);
+    oscillators[capstanThird].setFrequency(3.0 * flutterRate);
+    oscillators[pinchRoller].setFrequency(pinchRollerRatio * flutterRate);
+
+    // The delay line is sized for all of these at once, see getMaxExcursion
+    amplitudes[wow].setTargetValue(excursion(wowDepth, wowExcursionRate));
+    amplitudes[capstan].setTargetValue(excursion(flutterDepth, flutterExcursionRate));
+    amplitudes[capstanSecond].setTargetValue(excursion(flutterDepth * secondHarmonicDepth, 2.0 * flutterExcursionRate));
+    amplitudes[capstanThird].setTargetValue(excursion(flutterDepth * thirdHarmonicDepth, 3.0 * flutterExcursionRate));
+    amplitudes[pinchRoller].setTargetValue(excursion(flutterDepth * pinchRollerDepth, pinchRollerRatio * flutterExcursionRate));
+    scrapeAmplitude.setTargetValue(excursion(scrapeDepth, scrapeFrequency));
+}
+
+bool WowFlutter::isActive() const
+{
+    for (auto& amplitude : amplitudes)
+        if (amplitude.getTargetValue() > 0 || amplitude.isSmoothing())
+            return true;
+    return scrapeAmplitude.getTargetValue() > 0 || scrapeAmplitude.isSmoothing();
+}
+
+float WowFlutter::getNextNoise()
+{
+    // Hashing the control index instead of running a generator lets any position be jumped to
+    juce::uint64 x = (juce::uint64) controlIndex + 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return (float) (x >> 40) * (2.f / (float) (1 << 24)) - 1.f;
+}
+
+float WowFlutter::computeControlValue(bool fromZero)
+{
+    float value = 0;
+    float total = 0;
+    for (int i = 0; i < numOscillators; i++)
+    {
+        const float amplitude = amplitudes[i].getNextValue();
+        value += amplitude * oscillators[i].getNextSample();
+        total += amplitude;
+    }
+    const float scrape = scrapeAmplitude.getNextValue();
+    value += scrape * scrapeNormalisation * scrapeFilter.processSample(getNextNoise());
+    total += scrapeCrestFactor * scrape;
+    controlIndex++;
+    return fromZero ? juce::jmax(0.f, value + total) : juce::jlimit(-maxExcursion, maxExcursion, value);
+}
+
+void WowFlutter::getNextBlock(float* destination, int numSamples, bool fromZero)
+{
+    updateTargets();
+    int i = 0;
+    while (i < numSamples)
+    {
+        if (samplesUntilControl == 0)
+        {
+            increment = (computeControlValue(fromZero) - current) / (float) controlInterval;
+            samplesUntilControl = controlInterval;
+        }
+        const int count = juce::jmin(samplesUntilControl, numSamples - i);
+        for (int n = 0; n < count; n++)
+        {
+            destination[i + n] = current;
+            current += increment;
+        }
+        i += count;
+        samplesUntilControl -= count;
+    }
+}
+
+void WowFlutter::setTimelinePosition(juce::int64 samples)
+{
+    // Start at the control point before the position, so the ramp to the next one is already under way
+    const juce::int64 startIndex = samples / controlInterval;
+    const int offset = (int) (samples - startIndex * controlInterval);
+    const double seconds = (double) (startIndex * controlInterval) / sampleRate;
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    auto phase = [&] (double rate) { return juce::MathConstants<double>::pi + twoPi * std::fmod(seconds * rate, 1.0); };
+    updateTargets();
+    oscillators[wow].setPhase(phase(params.wowRate));
+    oscillators[capstan].setPhase(phase(params.flutterRate));
+    oscillators[capstanSecond].setPhase(phase(2.0 * params.flutterRate));
+    oscillators[capstanThird].setPhase(phase(3.0 * params.flutterRate));
+    oscillators[pinchRoller].setPhase(phase(pinchRollerRatio * params.flutterRate));
+    scrapeFilter.reset();
+    controlIndex = startIndex;
+    current = computeControlValue(params.tracking);
+    increment = (computeControlValue(params.tracking) - current) / (float) controlInterval;
+    current += increment * (float) offset;
+    samplesUntilControl = controlInterval - offset;
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    WowFlutter.h
+    Created: 17 Oct 2026 10:18:52pm
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+#include "Oscillator.h"
+
+/** Speed variations of the tape transport, as deviations of the delay in samples.
+
+    Wow is the slow drift of the supply and take-up reels. Flutter comes from the
+    capstan, its eccentricity adds harmonics, and from the pinch roller, which turns
+    slower than the capstan. Scrape flutter is the tape vibrating as it rubs over the
+    heads, band limited noise.
+
+    Every depth parameter maps linearly onto a peak deviation of the tape speed, the
+    top of its range onto half a percent for wow and flutter and a tenth for scrape.
+    A component moves the delay by that deviation over its angular rate; below a
+    minimum rate per source the excursion stays where it is at that rate, so the
+    delay line can hold every range at once.
+
+    Everything is computed once per controlInterval samples and interpolated linearly
+    in between, so more components cost next to nothing per sample.
+*/
+class WowFlutter
+{
+public:
+    WowFlutter(UserParameters& userParams) : params(userParams) {};
+    void prepare(double sampleRate, double maxExcursionSamples);
+    // Writes the delay deviation of the next numSamples samples. With fromZero it
+    // is shifted up by the current excursion, so it never goes below zero.
+    void getNextBlock(float* destination, int numSamples, bool fromZero);
+    // Lines the oscillators and the noise up with a playback that started at sample 0
+    void setTimelinePosition(juce::int64 samples);
+    // True while any component is on or fading out
+    bool isActive() const;
+    // Largest excursion the parameter ranges can ask for, in seconds either way
+    static double getMaxExcursion();
+    static constexpr int controlInterval = 16;
+private:
+    enum Component
+    {
+        wow,
+        capstan,
+        capstanSecond,
+        capstanThird,
+        pinchRoller,
+        numOscillators
+    };
+
+    float computeControlValue(bool fromZero);
+    void updateTargets();
+    float getNextNoise();
+
+    UserParameters& params;
+    double sampleRate = 44100;
+    double controlRate = 44100.0 / controlInterval;
+    float maxExcursion = 0;
+    std::array<Oscillator, numOscillators> oscillators;
+    // Peak delay deviation of every oscillator, in samples, ramped at the control rate
+    std::array<juce::SmoothedValue<float>, numOscillators> amplitudes;
+    juce::SmoothedValue<float> scrapeAmplitude;
+    juce::dsp::IIR::Filter<float> scrapeFilter;
+    float scrapeNormalisation = 1;
+    // Counts control steps from the start of playback and seeds the noise, so renders of segments line up
+    juce::int64 controlIndex = 0;
+    int samplesUntilControl = 0;
+    float current = 0;
+    float increment = 0;
+};
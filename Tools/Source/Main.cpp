@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026 12:24:17am
+    Author:  Levin
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../Source/TapeSim.h"
+#include "../../Source/Langevin.h"
+
+namespace
+{
+    // Spacing of the nodes, see HysteresisTable
+    constexpr double compression = 16.0;
+    constexpr int nodesPerUnit = 16;
+    // Deep enough into saturation for the loudest input the plugin takes at the highest drive
+    constexpr double maxQ = 512.0;
+    // Largest difference of the eco solver to RK4 that --check accepts
+    constexpr double maxErrorDecibels = -40.0;
+    // Half the error bound of the Langevin table's Hermite at its spacing, anything above it is a broken table
+    constexpr double maxLangevinError = 1.0e-8;
+
+    double getQ(double u) { return u / (1.0 - std::abs(u) / compression); }
+    double getQSlope(double u) { const double d = 1.0 - std::abs(u) / compression; return 1.0 / (d * d); }
+
+    double getSlopeOverU(const Hysteresis<double>& hysteresis, double u)
+    {
+        return hysteresis.getRisingSlope(getQ(u)) * getQSlope(u);
+    }
+
+    // Integral of the slope over one node spacing, Gauss-Legendre on a few sub-intervals
+    double integrate(const Hysteresis<double>& hysteresis, double from, double to)
+    {
+        constexpr int numIntervals = 4;
+        constexpr double points[] = { -0.9061798459386640, -0.5384693101056831, 0.0, 0.5384693101056831, 0.9061798459386640 };
+        constexpr double weights[] = { 0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891 };
+        const double width = (to - from) / numIntervals;
+        double sum = 0;
+        for (int interval = 0; interval < numIntervals; interval++)
+        {
+            const double centre = from + (interval + 0.5) * width;
+            for (int i = 0; i < 5; i++)
+                sum += weights[i] * getSlopeOverU(hysteresis, centre + points[i] * width * 0.5);
+        }
+        return sum * width * 0.5;
+    }
+
+    juce::String createTable()
+    {
+        UserParameters params;
+        Hysteresis<double> hysteresis(params);
+        // Sets the model constants
+        hysteresis.prepareToPlay(48000, 1, 1, 1);
+        const int half = (int) std::ceil(maxQ / (1.0 + maxQ / compression) * nodesPerUnit);
+        const int numNodes = 2 * half + 1;
+        std::vector<double> integral((size_t) numNodes), slope((size_t) numNodes);
+        // Integrate outwards from Q = 0 both ways, the slope has a kink there
+        for (int i = 0; i < numNodes; i++)
+            slope[(size_t) i] = getSlopeOverU(hysteresis, (double) (i - half) / nodesPerUnit);
+        for (int i = half + 1; i < numNodes; i++)
+            integral[(size_t) i] = integral[(size_t) i - 1] + integrate(hysteresis, (double) (i - 1 - half) / nodesPerUnit, (double) (i - half) / nodesPerUnit);
+        for (int i = half - 1; i >= 0; i--)
+            integral[(size_t) i] = integral[(size_t) i + 1] - integrate(hysteresis, (double) (i - half) / nodesPerUnit, (double) (i + 1 - half) / nodesPerUnit);
+
+        juce::String text;
+        text << "/*\n"
+                "  ==============================================================================\n\n"
+                "    HysteresisTableData.h\n"
+                "    Generated by Tools/hysteresis-table, don't edit\n\n"
+                "  ==============================================================================\n"
+                "*/\n\n"
+                "#pragma once\n\n"
+                "namespace HysteresisTableData\n"
+                "{\n"
+             << "    constexpr double compression = " << juce::String::formatted("%.1f", compression) << ";\n"
+             << "    constexpr int nodesPerUnit = " << nodesPerUnit << ";\n"
+             << "    constexpr int numNodes = " << numNodes << ";\n"
+             << "    // The integral and its slope over u at u = (i - numNodes / 2) / nodesPerUnit\n"
+                "    constexpr double nodes[numNodes][2] =\n"
+                "    {\n";
+        for (int i = 0; i < numNodes; i++)
+            text << juce::String::formatted("        { %.17g, %.17g },\n", integral[(size_t) i], slope[(size_t) i]);
+        text << "    };\n"
+                "}\n";
+        return text;
+    }
+
+    void generate(const juce::ArgumentList& args)
+    {
+        if (args.size() != 1 || args[0].isOption())
+            juce::ConsoleApplication::fail("Expected the output file");
+        auto output = args[0].resolveAsFile();
+        if (! output.replaceWithText(createTable()))
+            juce::ConsoleApplication::fail("Could not write " + output.getFullPathName());
+        std::cout << "Wrote " << output.getFullPathName() << std::endl;
+    }
+
+    // Runs a second of a sine through the hysteresis without bias, which RK4 only resolves well above 16x
+    std::vector<double> render(HysteresisSolver solver, int oversampling, double level)
+    {
+        constexpr double sampleRate = 48000;
+        constexpr int blockSize = 512;
+        const int numSamples = blockSize * oversampling;
+        UserParameters params;
+        params.solver = solver;
+        BiasSignal<double> bias;
+        RecordHead<double> recHead(params);
+        Hysteresis<double> hysteresis(params);
+        bias.prepareToPlay(sampleRate, oversampling, blockSize);
+        bias.setGain(0.f);
+        recHead.prepareToPlay(sampleRate, oversampling, blockSize);
+        hysteresis.prepareToPlay(sampleRate, oversampling, 1, blockSize);
+        const double rate = sampleRate * oversampling;
+        std::vector<IIRFilter<double>> lowPass;
+        lowPass.emplace_back(juce::dsp::IIR::Coefficients<double>::makeLowPass(rate, 24000.0, 1));
+        lowPass[0].prepare({ rate, (juce::uint32) numSamples, 1 });
+
+        std::vector<double> output;
+        juce::AudioBuffer<double> buffer(1, numSamples);
+        for (int start = 0; start < (int) rate; start += numSamples)
+        {
+            auto* data = buffer.getWritePointer(0);
+            for (int i = 0; i < numSamples; i++)
+                data[i] = level * std::sin(juce::MathConstants<double>::twoPi * 1000.0 * (start + i) / rate);
+            juce::dsp::AudioBlock<double> block(buffer);
+            hysteresis.processBlock(block, bias.getNextBlock(numSamples), recHead.getNextGains(numSamples), lowPass);
+            output.insert(output.end(), data, data + numSamples);
+        }
+        return output;
+    }
+
+    void check(const juce::ArgumentList&)
+    {
+        UserParameters params;
+        Hysteresis<double> hysteresis(params);
+        hysteresis.prepareToPlay(48000, 1, 1, 1);
+        double maxSlopeError = 0;
+        for (int i = 0; i < HysteresisTableData::numNodes; i++)
+        {
+            const double Q = HysteresisTable::getQ(HysteresisTable::getNodeU(i));
+            maxSlopeError = juce::jmax(maxSlopeError, std::abs(HysteresisTable::getNodeSlope(i) / hysteresis.getRisingSlope(Q) - 1.0));
+        }
+        std::cout << "Largest relative slope error of the nodes: " << maxSlopeError << std::endl;
+
+        bool failed = maxSlopeError > 1.0e-6;
+        for (double level : { 0.1, 0.5, 1.0 })
+        {
+            // RK4 at 64x against eco at 16x, every fourth sample lines up
+            const auto reference = render(HysteresisSolver::RK4, 64, level);
+            const auto eco = render(HysteresisSolver::Eco, 16, level);
+            double peak = 0, error = 0;
+            for (size_t i = 0; i < eco.size(); i++)
+            {
+                peak = juce::jmax(peak, std::abs(reference[i * 4]));
+                error = juce::jmax(error, std::abs(eco[i] - reference[i * 4]));
+            }
+            const double errorDecibels = juce::Decibels::gainToDecibels(error / peak);
+            std::cout << "Eco against RK4 at " << level << ": " << errorDecibels << " dB" << std::endl;
+            // The table gets within -55 dB, a model changed under it is far off
+            failed = failed || ! (errorDecibels < maxErrorDecibels);
+        }
+        if (failed)
+            juce::ConsoleApplication::fail("The table doesn't match the model, regenerate it");
+    }
+
+    void checkLangevin(const juce::ArgumentList&)
+    {
+        const double error = Langevin::get().getMaxError();
+        std::cout << "Largest error of the Langevin table: " << error << std::endl;
+        if (! (error < maxLangevinError))
+            juce::ConsoleApplication::fail("The Langevin table doesn't match the exact formula");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "Builds the table of the eco hysteresis solver from the exact model.", true);
+    app.addCommand({ "--check",
+                     "--check",
+                     "Compares the built in table with the model",
+                     "Prints the largest error of the table's slope and the difference of the eco solver\n"
+                     "to RK4 on a sine, and fails when the table was built from other constants.",
+                     check });
+    app.addCommand({ "--check-langevin",
+                     "--check-langevin",
+                     "Compares the Langevin table with the exact formula",
+                     "Prints the largest error of L, L' and L'' over both signs of Q, past the end of the\n"
+                     "table, and fails when it is above 1e-8.",
+                     checkLangevin });
+    app.addDefaultCommand({ "",
+                            "<output>",
+                            "Writes the table, usually to Source/HysteresisTableData.h",
+                            "Integrates the model's dM/dH while the field rises over the nodes of the table.",
+                            generate });
+    return app.findAndRunCommand(argc, argv);
+}